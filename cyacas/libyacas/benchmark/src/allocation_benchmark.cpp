@@ -0,0 +1,158 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "yacas/lispatom.h"
+#include "yacas/numbers.h"
+#include "yacas/yacas.h"
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace {
+    // Objects allocated per iteration
+    const int BATCH = 256;
+
+    // Every thread has an engine of its own, without the scripts
+    LispEnvironment& ThreadEnvironment()
+    {
+        thread_local std::ostringstream output;
+        thread_local CYacas yacas(output);
+        return yacas.getDefEnv().getEnv();
+    }
+
+    LispObject* NewAtom(LispEnvironment& env)
+    {
+        return LispAtom::New(env, "x");
+    }
+
+    LispObject* NewSubList(LispEnvironment&)
+    {
+        return LispSubList::New(nullptr);
+    }
+
+    LispObject* NewNumber(LispEnvironment&)
+    {
+        thread_local RefPtr<BigNumber> n(new BigNumber("12345", 10));
+        return new LispNumber(n);
+    }
+}
+
+// Every thread allocating and freeing objects of its own.
+static void BM_Allocate(benchmark::State& state, LispObject* (*make)(LispEnvironment&))
+{
+    LispEnvironment& env = ThreadEnvironment();
+
+    std::vector<LispPtr> objects(BATCH);
+
+    for (auto _ : state) {
+        for (LispPtr& p: objects)
+            p = make(env);
+        for (LispPtr& p: objects)
+            p = nullptr;
+    }
+
+    state.SetItemsProcessed(state.iterations() * BATCH);
+}
+
+BENCHMARK_CAPTURE(BM_Allocate, atom, NewAtom)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_CAPTURE(BM_Allocate, sublist, NewSubList)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_CAPTURE(BM_Allocate, number, NewNumber)->ThreadRange(1, 8)->UseRealTime();
+
+// Allocating objects that all stay alive, so that the pool keeps
+// running out of room and grows to many slabs.
+static void BM_Grow(benchmark::State& state)
+{
+    LispEnvironment& env = ThreadEnvironment();
+
+    std::vector<LispPtr> objects(state.range(0));
+
+    for (auto _ : state) {
+        for (LispPtr& p: objects)
+            p = NewSubList(env);
+
+        state.PauseTiming();
+        for (LispPtr& p: objects)
+            p = nullptr;
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Grow)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+
+// Threads handing the objects they allocated to each other to free.
+static void BM_CrossThreadFree(benchmark::State& state)
+{
+    static std::mutex lock;
+    static std::vector<LispPtr> pending;
+
+    LispEnvironment& env = ThreadEnvironment();
+
+    std::vector<LispPtr> objects;
+
+    for (auto _ : state) {
+        for (int i = 0; i < BATCH; ++i)
+            objects.push_back(NewSubList(env));
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            std::swap(objects, pending);
+        }
+
+        objects.clear();
+    }
+
+    // The last thread to finish frees the last batch
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        pending.clear();
+    }
+
+    state.SetItemsProcessed(state.iterations() * BATCH);
+}
+
+BENCHMARK(BM_CrossThreadFree)->ThreadRange(1, 8)->UseRealTime();
+
+// Dropping an expression nested a million levels deep: the release
+// itself takes apart one slice of it, the next evaluations take care
+// of the rest.
+static void BM_DropDeepExpression(benchmark::State& state)
+{
+    LispEnvironment& env = ThreadEnvironment();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        LispPtr e(NewAtom(env));
+        for (int i = 0; i < state.range(0); ++i)
+            e = LispSubList::New(e);
+        state.ResumeTiming();
+
+        e = nullptr;
+
+        state.PauseTiming();
+        LispReclaimer::Collect(static_cast<std::size_t>(-1));
+        state.ResumeTiming();
+    }
+}
+
+BENCHMARK(BM_DropDeepExpression)->Arg(1 << 20)->Unit(benchmark::kMicrosecond);
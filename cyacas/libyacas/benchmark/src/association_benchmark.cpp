@@ -0,0 +1,122 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engine.h"
+
+#include "yacas/associationclass.h"
+
+#include <vector>
+
+// Keys of association benchmarks: numbers, atoms and small expressions
+// f(i, x), the kinds of keys the scripts use, and numbers of more than
+// 53 bits and floats, which do not hash like machine integers.
+static std::vector<LispPtr> Keys(int n, const std::string& kind)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    std::vector<LispPtr> keys;
+    keys.reserve(n);
+
+    for (int i = 0; i < n; ++i) {
+        const std::string s = std::to_string(i);
+        if (kind == "number")
+            keys.push_back(LispAtom::New(env, s));
+        else if (kind == "bignumber")
+            keys.push_back(LispAtom::New(env, "1" + std::string(20 - s.size(), '0') + s));
+        else if (kind == "float")
+            keys.push_back(LispAtom::New(env, "0." + std::string(7 - s.size(), '0') + s));
+        else if (kind == "atom")
+            keys.push_back(LispAtom::New(env, "k" + s));
+        else
+            keys.push_back(LispSubList::New(LispObjectAdder(LispAtom::New(env, "f")) +
+                                            LispObjectAdder(LispAtom::New(env, s)) +
+                                            LispObjectAdder(LispAtom::New(env, "x"))));
+    }
+
+    return keys;
+}
+
+// Filling an association with n entries, per entry
+static void BM_AssociationSet(benchmark::State& state, const char* kind)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    const int n = state.range(0);
+    const std::vector<LispPtr> keys = Keys(n, kind);
+
+    for (auto _ : state) {
+        AssociationClass a(env);
+        for (const LispPtr& k : keys)
+            a.SetElement(k, k);
+        benchmark::DoNotOptimize(a.Size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Looking up the keys of an association with n entries, per lookup
+static void BM_AssociationGet(benchmark::State& state, const char* kind)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    const int n = state.range(0);
+    const std::vector<LispPtr> keys = Keys(n, kind);
+
+    AssociationClass a(env);
+    for (const LispPtr& k : keys)
+        a.SetElement(k, k);
+
+    // Equal keys, not the same objects
+    const std::vector<LispPtr> lookups = Keys(n, kind);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a.GetElement(lookups[i]));
+        if (++i == lookups.size())
+            i = 0;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+#define ASSOCIATION_BENCHMARK(kind)                                            \
+    BENCHMARK_CAPTURE(BM_AssociationSet, kind, #kind)                          \
+        ->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond); \
+    BENCHMARK_CAPTURE(BM_AssociationGet, kind, #kind)                          \
+        ->Arg(1000)->Arg(100000)->Arg(1000000)
+
+ASSOCIATION_BENCHMARK(number);
+ASSOCIATION_BENCHMARK(bignumber);
+ASSOCIATION_BENCHMARK(float);
+ASSOCIATION_BENCHMARK(atom);
+ASSOCIATION_BENCHMARK(expression);
+
+// The scripts using associations
+static void BM_AssociationScript(benchmark::State& state, const char* expr)
+{
+    const std::string e = std::string(expr) + ";";
+
+    Run(state, e);
+
+    for (auto _ : state)
+        Run(state, e);
+}
+
+BENCHMARK_CAPTURE(BM_AssociationScript, cse, "CSE(Sin(x)^2+Cos(x)^2+Sin(x)*Cos(x)+Sin(x)^3)")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_AssociationScript, fill, "[Local(a); a := Association'Create(); ForEach(i, 1 .. 2000) Association'Set(a, f(i), i); Association'Size(a);]")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_AssociationScript, head, "[Local(a); a := Association'Create(); ForEach(i, 1 .. 2000) [Association'Set(a, f(i), i); Association'Head(a);]; Association'Size(a);]")->Unit(benchmark::kMillisecond);
@@ -0,0 +1,169 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engine.h"
+
+#include <string>
+
+// Naive Fibonacci written with rules, on kernel arithmetic only, so
+// that the time goes into calling the user function: argument
+// evaluation, binding the parameters and picking the rule.
+static void BM_Fibonacci(benchmark::State& state)
+{
+    const int n = state.range(0);
+
+    Run(state, "Retract(\"CallFib\", 1);");
+    Run(state, "10 # CallFib(0) <-- 0;");
+    Run(state, "10 # CallFib(1) <-- 1;");
+    Run(state,
+        "20 # CallFib(_n) <-- "
+        "MathAdd(CallFib(MathSubtract(n, 1)), CallFib(MathSubtract(n, 2)));");
+
+    const std::string call = "CallFib(" + std::to_string(n) + ");";
+
+    // CallFib(n) makes 2 CallFib(n + 1) - 1 calls
+    long long a = 0, b = 1;
+    for (int i = 0; i <= n; ++i) {
+        const long long c = a + b;
+        a = b;
+        b = c;
+    }
+    const long long calls = 2 * a - 1;
+
+    for (auto _ : state)
+        Run(state, call);
+
+    state.counters["calls"] =
+        benchmark::Counter(calls, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_Fibonacci)->Arg(15)->Arg(20)->Unit(benchmark::kMillisecond);
+
+// The same with a plain function, as defined by Function(), whose one
+// rule always matches.
+static void BM_Function(benchmark::State& state)
+{
+    Run(state, "Retract(\"CallTwice\", 1);");
+    Run(state, "Function(\"CallTwice\", {x}) MathAdd(x, x);");
+
+    for (auto _ : state)
+        Run(state, "[Local(i); For(i := 0, i < 1000, i++) CallTwice(i);];");
+
+    state.counters["calls"] =
+        benchmark::Counter(1000, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_Function)->Unit(benchmark::kMillisecond);
+
+// The Fibonacci above, memoized, starting from no results remembered,
+// so that every one of the n + 1 values is computed once.
+static void BM_MemoizedFibonacci(benchmark::State& state)
+{
+    const int n = state.range(0);
+
+    Run(state, "Retract(\"MemoFib\", 1);");
+    Run(state, "10 # MemoFib(0) <-- 0;");
+    Run(state, "10 # MemoFib(1) <-- 1;");
+    Run(state,
+        "20 # MemoFib(_n) <-- "
+        "MathAdd(MemoFib(MathSubtract(n, 1)), MemoFib(MathSubtract(n, 2)));");
+    Run(state, "Memoize(\"MemoFib\", 1);");
+
+    const std::string call = "MemoFib(" + std::to_string(n) + ");";
+
+    for (auto _ : state) {
+        Run(state, "Memoize'Set(\"MemoFib\", 1, 0);");
+        Run(state, "Memoize'Set(\"MemoFib\", 1, 1024);");
+        Run(state, call);
+    }
+}
+
+BENCHMARK(BM_MemoizedFibonacci)->Arg(20)->Arg(200)->Unit(benchmark::kMillisecond);
+
+// A loop written as a rule calling itself in tail position, which
+// runs in the frame of the first call.
+static void BM_TailCall(benchmark::State& state)
+{
+    const int n = state.range(0);
+
+    Run(state, "Retract(\"CallLoop\", 2);");
+    Run(state, "10 # CallLoop(0, _acc) <-- acc;");
+    Run(state,
+        "20 # CallLoop(_n, _acc) <-- "
+        "CallLoop(MathSubtract(n, 1), MathAdd(acc, 1));");
+
+    const std::string call = "CallLoop(" + std::to_string(n) + ", 0);";
+
+    for (auto _ : state)
+        Run(state, call);
+
+    state.counters["calls"] =
+        benchmark::Counter(n + 1, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_TailCall)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// A rule whose body is a loop: the time goes into evaluating the body,
+// its control flow, local variables and kernel functions, rather than
+// into calling user functions.
+static void BM_RuleBody(benchmark::State& state)
+{
+    const int n = state.range(0);
+
+    Run(state, "Retract(\"CallSum\", 1);");
+    Run(state,
+        "Function(\"CallSum\", {n}) [ Local(i, s); Set(i, 0); Set(s, 0); "
+        "While(LessThan(i, n)) [ "
+        "If(Equals(MathMod(i, 3), 0), Set(s, MathAdd(s, i))); "
+        "Set(i, MathAdd(i, 1)); ]; s; ];");
+
+    const std::string call = "CallSum(" + std::to_string(n) + ");";
+
+    for (auto _ : state)
+        Run(state, call);
+
+    state.counters["iterations"] =
+        benchmark::Counter(n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_RuleBody)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// A macro called over and over with the same arguments, from a loop:
+// the time goes into expanding its body and evaluating the expansion.
+static void BM_MacroCall(benchmark::State& state)
+{
+    const int n = state.range(0);
+
+    Run(state, "Retract(\"CallSwap\", 2);");
+    Run(state,
+        "Macro(\"CallSwap\", {a, b}) "
+        "[ Local(t); Set(t, @a); Set(@a, @b); Set(@b, t); ];");
+
+    const std::string call =
+        "[ Local(i, x, y); Set(i, 0); Set(x, 1); Set(y, 2); "
+        "While(LessThan(i, " + std::to_string(n) + ")) "
+        "[ CallSwap(x, y); Set(i, MathAdd(i, 1)); ]; x; ];";
+
+    for (auto _ : state)
+        Run(state, call);
+
+    state.counters["calls"] =
+        benchmark::Counter(n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MacroCall)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,79 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef YACAS_BENCHMARK_ENGINE_H
+#define YACAS_BENCHMARK_ENGINE_H
+
+#include "yacas/infixparser.h"
+#include "yacas/stringio.h"
+#include "yacas/yacas.h"
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+
+/// Output of the engine, discarded after every evaluation.
+inline std::ostringstream& EngineOutput()
+{
+    static std::ostringstream output;
+    return output;
+}
+
+/// The engine shared by all benchmarks, with the standard scripts
+/// loaded.
+inline CYacas& Engine()
+{
+    static CYacas* yacas = nullptr;
+
+    if (!yacas) {
+        yacas = new CYacas(EngineOutput());
+        yacas->Evaluate("DefaultDirectory(\"" YACAS_SCRIPTS_DIR "/\");");
+        yacas->Evaluate("Load(\"yacasinit.ys\");");
+    }
+
+    return *yacas;
+}
+
+/// Evaluate \a expr, stopping the benchmark if it fails.
+inline void Run(benchmark::State& state, const std::string& expr)
+{
+    Engine().Evaluate(expr);
+    if (Engine().IsError())
+        state.SkipWithError(Engine().Error().c_str());
+    EngineOutput().str("");
+}
+
+/// Parse \a expr without evaluating it.
+inline LispPtr Parse(const std::string& expr)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    StringInput input(expr + ";", env.iInputStatus);
+    InfixParser parser(*env.iCurrentTokenizer,
+                       input,
+                       env,
+                       env.PreFix(),
+                       env.InFix(),
+                       env.PostFix(),
+                       env.Bodied());
+    LispPtr result;
+    parser.Parse(result);
+    return result;
+}
+
+#endif
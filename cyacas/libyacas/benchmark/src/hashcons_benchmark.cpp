@@ -0,0 +1,104 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engine.h"
+
+#include "yacas/standard.h"
+
+// Comparing two equal, separately built expressions of n terms: plain
+// lists are walked element by element, hash-consed ones share their
+// elements.
+static LispPtr Polynomial(int n)
+{
+    std::string e = "x";
+    for (int i = 1; i < n; ++i)
+        e += "+" + std::to_string(i) + "*x^" + std::to_string(i);
+    return Parse(e);
+}
+
+static void BM_Equals(benchmark::State& state)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    const int n = state.range(0);
+    const LispPtr a = Polynomial(n);
+    const LispPtr b = Polynomial(n);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(InternalEquals(env, a, b));
+
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_Equals)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+
+static void BM_EqualsHashConsed(benchmark::State& state)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    const int n = state.range(0);
+    const LispPtr a = env.iHashCons.Cons(env, Polynomial(n));
+    const LispPtr b = env.iHashCons.Cons(env, Polynomial(n));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(InternalEquals(env, a, b));
+
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_EqualsHashConsed)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+
+// Telling apart expressions differing in their last term
+static void BM_Differ(benchmark::State& state, bool consed)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    const int n = state.range(0);
+    LispPtr a = Polynomial(n);
+    LispPtr b = Polynomial(n + 1);
+
+    if (consed) {
+        a = env.iHashCons.Cons(env, a);
+        b = env.iHashCons.Cons(env, b);
+    }
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(InternalEquals(env, a, b));
+
+    state.SetComplexityN(n);
+}
+
+BENCHMARK_CAPTURE(BM_Differ, plain, false)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+BENCHMARK_CAPTURE(BM_Differ, hashconsed, true)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+
+// The cost of hash-consing an expression already in the table
+static void BM_HashCons(benchmark::State& state)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    const int n = state.range(0);
+    const LispPtr a = Polynomial(n);
+    const LispPtr kept = env.iHashCons.Cons(env, a);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(env.iHashCons.Cons(env, a));
+
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_HashCons)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
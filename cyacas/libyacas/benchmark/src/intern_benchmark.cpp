@@ -0,0 +1,110 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engine.h"
+
+#include "yacas/lisphash.h"
+#include "yacas/tokenizer.h"
+
+#include <fstream>
+#include <iterator>
+#include <string_view>
+
+// Looking up symbols that are already interned, as the parser does
+// for nearly every token.
+static void BM_LookUpHit(benchmark::State& state)
+{
+    LispHashTable& hash = Engine().getDefEnv().getEnv().HashTable();
+
+    const std::string_view symbols[] = {
+        "Sin", "Cos", "x", "+", "*", "(", ")", "Deriv", "Simplify", "List"
+    };
+
+    for (auto _ : state)
+        for (std::string_view s: symbols)
+            benchmark::DoNotOptimize(hash.LookUp(s));
+
+    state.SetItemsProcessed(state.iterations() * std::size(symbols));
+}
+
+BENCHMARK(BM_LookUpHit);
+
+// Tokenizing and interning a script-sized input.
+static void BM_Tokenize(benchmark::State& state)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    std::string text;
+    for (int i = 0; i < 100; ++i)
+        text += "f(x_IsAtom, y_IsNumber) <-- Sin(x) * Cos(y) + 2.5e3 /* c */;\n";
+
+    std::size_t tokens = 0;
+
+    for (auto _ : state) {
+        StringInput input(text, env.iInputStatus);
+        LispTokenizer tokenizer;
+        while (!env.HashTable().LookUp(tokenizer.NextToken(input))->empty())
+            tokens += 1;
+    }
+
+    state.SetItemsProcessed(tokens);
+}
+
+BENCHMARK(BM_Tokenize);
+
+// Building atoms from strings at run time.
+static void BM_Atomize(benchmark::State& state)
+{
+    Run(state, "atomize'strings := MapSingle(\"String\", 1 .. 100);");
+
+    for (auto _ : state)
+        Run(state, "MapSingle(\"Atom\", atomize'strings);");
+}
+
+BENCHMARK(BM_Atomize);
+
+// Reading a standard script is dominated by tokenizing and interning.
+static void BM_ParseScript(benchmark::State& state)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    std::ifstream file(YACAS_SCRIPTS_DIR "/deriv.rep/code.ys");
+    const std::string text((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+
+    for (auto _ : state) {
+        StringInput input(text, env.iInputStatus);
+        InfixParser parser(*env.iCurrentTokenizer,
+                           input,
+                           env,
+                           env.PreFix(),
+                           env.InFix(),
+                           env.PostFix(),
+                           env.Bodied());
+        for (;;) {
+            LispPtr e;
+            parser.Parse(e);
+            if (e->String() == env.iEndOfFile->String())
+                break;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(BM_ParseScript);
@@ -0,0 +1,65 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engine.h"
+
+// Reading the last element of a list of n elements
+static void BM_Nth(benchmark::State& state)
+{
+    const int n = state.range(0);
+
+    Run(state, "listIndexBenchmark := 1 .. " + std::to_string(n) + ";");
+
+    const std::string e = "listIndexBenchmark[" + std::to_string(n) + "];";
+
+    for (auto _ : state)
+        Run(state, e);
+
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_Nth)->RangeMultiplier(4)->Range(16, 4096)->Complexity();
+
+// Multiplying n by n matrices stored as lists of lists, element by
+// element
+static void BM_MatrixProduct(benchmark::State& state)
+{
+    const std::string n = std::to_string(state.range(0));
+
+    Run(state, "listIndexA := RandomIntegerMatrix(" + n + ", " + n + ", -9, 9);");
+    Run(state, "listIndexB := RandomIntegerMatrix(" + n + ", " + n + ", -9, 9);");
+
+    const std::string e =
+        "[Local(i, j, k, s, c);"
+        " c := ZeroMatrix(" + n + ", " + n + ");"
+        " For(i := 1, i <= " + n + ", i++)"
+        "  For(j := 1, j <= " + n + ", j++) ["
+        "   s := 0;"
+        "   For(k := 1, k <= " + n + ", k++)"
+        "    s := s + listIndexA[i][k] * listIndexB[k][j];"
+        "   c[i][j] := s;"
+        "  ];"
+        " c;];";
+
+    for (auto _ : state)
+        Run(state, e);
+
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_MatrixProduct)->RangeMultiplier(2)->Range(8, 64)->Unit(benchmark::kMillisecond)->Complexity();
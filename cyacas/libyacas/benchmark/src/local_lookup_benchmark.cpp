@@ -0,0 +1,43 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engine.h"
+
+#include <sstream>
+
+// Read a variable declared in the outermost of n nested Local blocks,
+// each declaring a few variables of its own: the time should not grow
+// with n.
+static void BM_LocalLookup(benchmark::State& state)
+{
+    const int n = state.range(0);
+
+    std::ostringstream expr;
+    for (int i = 0; i < n; ++i)
+        expr << "[Local(a" << i << ",b" << i << ",c" << i << ");";
+    expr << "For(i := 0, i < 100, i++) a0;";
+    for (int i = 0; i < n; ++i)
+        expr << "];";
+
+    for (auto _ : state)
+        Run(state, expr.str());
+
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_LocalLookup)->RangeMultiplier(4)->Range(1, 256)->Complexity();
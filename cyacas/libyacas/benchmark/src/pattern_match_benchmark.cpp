@@ -0,0 +1,81 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engine.h"
+
+#include "yacas/patterns.h"
+
+// One rule attempt: match the arguments of \a expr against the
+// parameters of \a pattern and check \a predicate, like
+// BranchingUserFunction does for every rule it tries.
+static void BM_RuleAttempt(benchmark::State& state,
+                           const char* pattern,
+                           const char* predicate,
+                           const char* expr,
+                           bool matches)
+{
+    LispEnvironment& env = Engine().getDefEnv().getEnv();
+
+    LispPtr p = Parse(pattern);
+    LispPtr post = Parse(predicate);
+    YacasPatternPredicateBase matcher(env, (*p->SubList())->Nixed(), post);
+
+    LispPtr e = Parse(expr);
+    std::vector<LispPtr> arguments;
+    for (LispIterator iter((*e->SubList())->Nixed()); iter.getObj(); ++iter)
+        arguments.push_back(iter.getObj()->Copy());
+
+    for (auto _ : state) {
+        LispLocalFrame frame(env, true);
+        if (matcher.Matches(env, arguments.data()) != matches)
+            state.SkipWithError("unexpected match result");
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_RuleAttempt, deriv_sin,
+                  "Deriv(_var)Sin(_x)", "True",
+                  "Deriv(x)Sin(x^2)", true);
+BENCHMARK_CAPTURE(BM_RuleAttempt, deriv_not_sin,
+                  "Deriv(_var)Sin(_x)", "True",
+                  "Deriv(x)Cos(x^2)", false);
+BENCHMARK_CAPTURE(BM_RuleAttempt, deriv_quotient,
+                  "Deriv(_var)(_x / _y)", "IsFreeOf(var, y)",
+                  "Deriv(x)(x^2 / a)", true);
+BENCHMARK_CAPTURE(BM_RuleAttempt, deriv_quotient_predicate_fails,
+                  "Deriv(_var)(_x / _y)", "IsFreeOf(var, y)",
+                  "Deriv(x)(a / x)", false);
+BENCHMARK_CAPTURE(BM_RuleAttempt, simplify_power,
+                  "SimpFlatten((_x)^(n_IsPositiveInteger))", "True",
+                  "SimpFlatten((x+1)^3)", true);
+BENCHMARK_CAPTURE(BM_RuleAttempt, simplify_implode_fails,
+                  "SimpImplode(SimpMul(SimpAdd(_x,_y),_z))", "True",
+                  "SimpImplode(SimpMul(a,SimpAdd(b,c)))", false);
+
+// Whole Deriv and Simplify calls, dominated by rule attempts.
+static void BM_Evaluate(benchmark::State& state, const char* expr)
+{
+    Run(state, expr);
+
+    for (auto _ : state)
+        Run(state, expr);
+}
+
+BENCHMARK_CAPTURE(BM_Evaluate, deriv, "Deriv(x) Sin(x)^3*Exp(x)/(1+x^2);");
+BENCHMARK_CAPTURE(BM_Evaluate, simplify, "Simplify((x^2-1)/(x-1) + (x+1)^2);")->Unit(benchmark::kMillisecond);
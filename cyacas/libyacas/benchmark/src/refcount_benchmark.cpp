@@ -0,0 +1,47 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engine.h"
+
+// Evaluating an expression, reporting the reference count operations
+// per evaluation. The counts are only kept when the engine is built
+// with ENABLE_CYACAS_REFCOUNT_STATISTICS.
+static void BM_RefCount(benchmark::State& state, const char* expr)
+{
+    const std::string e = std::string(expr) + ";";
+
+    Run(state, e);
+
+#ifdef YACAS_REFCOUNT_STATISTICS
+    const unsigned long long before = RefCountOperations;
+#endif
+
+    for (auto _ : state)
+        Run(state, e);
+
+#ifdef YACAS_REFCOUNT_STATISTICS
+    state.counters["refcount_ops"] = benchmark::Counter(
+        RefCountOperations - before, benchmark::Counter::kAvgIterations);
+#endif
+}
+
+BENCHMARK_CAPTURE(BM_RefCount, deriv, "Deriv(x) Sin(x)^2*Exp(x)");
+BENCHMARK_CAPTURE(BM_RefCount, simplify, "Simplify((x+1)^2-(x-1)^2)");
+BENCHMARK_CAPTURE(BM_RefCount, list, "Length(Reverse(Concat(1 .. 100, 1 .. 100)))");
+BENCHMARK_CAPTURE(BM_RefCount, substitute, "Subst(x, y+1) Expand((x+1)^5)");
+BENCHMARK_CAPTURE(BM_RefCount, recursion, "[Local(f); f(n) := If(n < 2, n, f(n-1) + f(n-2)); f(12);]");
@@ -0,0 +1,69 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engine.h"
+
+#include <sstream>
+
+// A rule base with one rule per atom, called on the last atom: a
+// linear scan over the rules is O(n), dispatch on the argument is
+// O(1).
+static void BM_RuleDispatch(benchmark::State& state)
+{
+    const int n = state.range(0);
+
+    std::ostringstream f;
+    f << "RuleDispatch" << n;
+
+    std::ostringstream def;
+    def << "Retract(\"" << f.str() << "\", 1);";
+    for (int i = 0; i < n; ++i)
+        def << i << " # " << f.str() << "(a" << i << ") <-- " << i << ";";
+
+    Run(state, def.str());
+
+    const std::string call = f.str() + "(a" + std::to_string(n - 1) + ");";
+
+    for (auto _ : state)
+        Run(state, call);
+
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_RuleDispatch)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+
+// The test suite: mostly rule dispatch over the standard scripts.
+// The first run also loads the scripts the test needs, it is not
+// timed.
+static void BM_TestSuite(benchmark::State& state, const char* test)
+{
+    const std::string load =
+        std::string("Load(\"" YACAS_TESTS_DIR "/") + test + "\");";
+
+    Run(state, load);
+
+    for (auto _ : state)
+        Run(state, load);
+}
+
+BENCHMARK_CAPTURE(BM_TestSuite, deriv, "deriv.yts")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_TestSuite, simplify, "simplify.yts")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_TestSuite, poly, "poly.yts")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_TestSuite, integrate, "integrate.yts")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_TestSuite, solve, "solve.yts")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_TestSuite, lists, "lists.yts")->Unit(benchmark::kMillisecond);
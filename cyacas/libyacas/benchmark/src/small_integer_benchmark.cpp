@@ -0,0 +1,38 @@
+/*
+ *
+ * This file is part of yacas.
+ * Yacas is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesset General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Yacas is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with yacas.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engine.h"
+
+// Arithmetic on machine word integers: loop counters, indices and
+// small coefficients
+static void BM_SmallInteger(benchmark::State& state, const char* expr)
+{
+    const std::string e = std::string(expr) + ";";
+
+    Run(state, e);
+
+    for (auto _ : state)
+        Run(state, e);
+}
+
+BENCHMARK_CAPTURE(BM_SmallInteger, add, "MathAdd(123456, 654321)");
+BENCHMARK_CAPTURE(BM_SmallInteger, multiply, "MathMultiply(-1234, 4321)");
+BENCHMARK_CAPTURE(BM_SmallInteger, compare, "LessThan(123456, 654321)");
+BENCHMARK_CAPTURE(BM_SmallInteger, loop, "[Local(i, s); s := 0; For(i := 1, i <= 1000, i++) s := s + i * i; s;]")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SmallInteger, expand, "Expand((x + 2*y - 3)^6)")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SmallInteger, overflow, "[Local(i, s); s := 1; For(i := 1, i <= 100, i++) s := s * 3; s;]")->Unit(benchmark::kMillisecond);
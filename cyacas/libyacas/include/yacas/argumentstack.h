@@ -0,0 +1,114 @@
+/** \file argumentstack.h
+ *  the values of the arguments of user function calls.
+ */
+
+#ifndef YACAS_ARGUMENTSTACK_H
+#define YACAS_ARGUMENTSTACK_H
+
+#include "lispobject.h"
+#include "noncopyable.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Stack of the evaluated arguments of the user function calls in
+ * progress, which also hold the values of their parameters.
+ * The arguments of one call take consecutive slots, which stay where
+ * they are until the call returns: the stack grows by adding blocks,
+ * never by moving slots. The blocks are kept once allocated, so that
+ * a call takes nothing from the heap once the stack has been that
+ * deep before.
+ */
+class ArgumentStack: NonCopyable {
+public:
+    static constexpr std::size_t BLOCK_SIZE = 1024;
+
+    /// Slots for the arguments of one call, emptied and released again
+    /// when going out of scope.
+    class Frame: NonCopyable {
+    public:
+        Frame(ArgumentStack& aStack, std::size_t aSize);
+        ~Frame();
+
+        LispPtr* get() const { return iSlots; }
+        std::size_t size() const { return iSize; }
+        LispPtr& operator[](std::size_t i) const { return iSlots[i]; }
+
+    private:
+        ArgumentStack& iStack;
+        LispPtr* iSlots;
+        std::size_t iSize;
+        /// Top of the stack before the frame was pushed
+        std::size_t iBlock;
+        std::size_t iTop;
+    };
+
+    ArgumentStack();
+
+private:
+    struct Block {
+        explicit Block(std::size_t aSize):
+            slots(new LispPtr[aSize]), size(aSize) {}
+
+        std::unique_ptr<LispPtr[]> slots;
+        std::size_t size;
+    };
+
+    /// Move on to a block of at least \a aSize slots.
+    void NextBlock(std::size_t aSize);
+
+    std::vector<Block> _blocks;
+    /// Block the top of the stack is in
+    std::size_t _block;
+    /// First free slot in #_block
+    std::size_t _top;
+};
+
+inline
+ArgumentStack::ArgumentStack():
+    _block(0),
+    _top(0)
+{
+    _blocks.emplace_back(BLOCK_SIZE);
+}
+
+inline
+void ArgumentStack::NextBlock(std::size_t aSize)
+{
+    _block += 1;
+    _top = 0;
+
+    if (_block == _blocks.size())
+        _blocks.emplace_back(std::max(aSize, BLOCK_SIZE));
+    else if (_blocks[_block].size < aSize)
+        _blocks[_block] = Block(aSize);
+}
+
+inline
+ArgumentStack::Frame::Frame(ArgumentStack& aStack, std::size_t aSize):
+    iStack(aStack),
+    iSize(aSize),
+    iBlock(aStack._block),
+    iTop(aStack._top)
+{
+    if (iStack._top + aSize > iStack._blocks[iStack._block].size)
+        iStack.NextBlock(aSize);
+
+    iSlots = iStack._blocks[iStack._block].slots.get() + iStack._top;
+    iStack._top += aSize;
+}
+
+inline
+ArgumentStack::Frame::~Frame()
+{
+    for (std::size_t i = 0; i < iSize; ++i)
+        iSlots[i] = nullptr;
+
+    iStack._block = iBlock;
+    iStack._top = iTop;
+}
+
+#endif
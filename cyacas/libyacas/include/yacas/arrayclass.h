@@ -12,6 +12,9 @@ public:
     //required
     ArrayClass(std::size_t aSize,LispObject* aInitialItem);
     const char* TypeName() const override;
+    void References(std::vector<LispObject*>& aObjects) const override;
+    void Clear() override;
+    std::size_t Footprint() const override;
 
     //array-specific
     std::size_t Size() const;
@@ -34,6 +37,26 @@ const char* ArrayClass::TypeName() const
     return "\"Array\"";
 }
 
+inline
+void ArrayClass::References(std::vector<LispObject*>& aObjects) const
+{
+    for (const LispPtr& p: iArray)
+        if (p)
+            aObjects.push_back(p);
+}
+
+inline
+void ArrayClass::Clear()
+{
+    iArray.clear();
+}
+
+inline
+std::size_t ArrayClass::Footprint() const
+{
+    return sizeof (ArrayClass) + iArray.capacity() * sizeof (LispPtr);
+}
+
 inline
 std::size_t ArrayClass::Size() const
 {
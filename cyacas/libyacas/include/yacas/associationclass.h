@@ -29,13 +29,27 @@
 #include "genericobject.h"
 #include "standard.h"
 
-#include <map>
-
+#include <functional>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+/// Association of expressions with values. The entries are hashed on
+/// the structure of their keys, InternalHash(), so InternalEquals()
+/// only compares keys with the same hash. Keys(), ToList() and Head()
+/// go by an index of the entries ordered by InternalStrictTotalOrder(),
+/// so that they do not depend on the hashes. The index is built when
+/// first needed and kept up to date from then on, so associations
+/// never asked for their order do not pay for it.
 class AssociationClass final: public GenericClass
 {
 public:
     AssociationClass(const LispEnvironment& env);
     const char* TypeName() const override;
+    void References(std::vector<LispObject*>& aObjects) const override;
+    void Clear() override;
+    std::size_t Footprint() const override;
 
     std::size_t Size() const;
     bool Contains(LispObject* k) const;
@@ -50,11 +64,11 @@ private:
     class Key {
     public:
         Key(const LispEnvironment& env, LispObject* p):
-            value(p), _env(env) {}
+            value(p), hash(InternalHash(env, value)), _env(env) {}
         
         bool operator == (const Key& rhs) const
         {
-            return InternalEquals(_env, value, rhs.value);
+            return hash == rhs.hash && InternalEquals(_env, value, rhs.value);
         }
         
         bool operator < (const Key& rhs) const
@@ -63,13 +77,40 @@ private:
         }
 
         LispPtr value;
+        std::size_t hash;
 
     private:
         const LispEnvironment& _env;
     };
 
+    struct KeyHash {
+        std::size_t operator()(const Key& k) const { return k.hash; }
+    };
+
+    typedef std::unordered_map<Key, LispPtr, KeyHash> Map;
+
+    /// Order of the keys; entries with keys neither is less than go by
+    /// their address, so that no entry is left out of the index
+    struct KeyOrder {
+        bool operator()(Map::const_pointer a, Map::const_pointer b) const
+        {
+            if (a->first < b->first)
+                return true;
+            if (b->first < a->first)
+                return false;
+            return std::less<Map::const_pointer>()(a, b);
+        }
+    };
+
+    typedef std::set<Map::const_pointer, KeyOrder> Order;
+
+    /// The entries, in the order of their keys
+    const Order& Ordered() const;
+
     const LispEnvironment& _env;
-    std::map<Key, LispPtr> _map;
+    Map _map;
+    /// Index of #_map, nullptr until Ordered() is first called
+    mutable std::unique_ptr<Order> _order;
 };
 
 inline
@@ -84,6 +125,28 @@ const char* AssociationClass::TypeName() const
     return "\"Association\"";
 }
 
+inline
+void AssociationClass::Clear()
+{
+    _order = nullptr;
+    _map.clear();
+}
+
+inline
+std::size_t AssociationClass::Footprint() const
+{
+    // Every entry is a node of its own, with a pointer to the next
+    std::size_t size = sizeof (AssociationClass) +
+                       _map.bucket_count() * sizeof (void*) +
+                       _map.size() * (sizeof (Map::value_type) + sizeof (void*));
+
+    // A node of the index holds the entry and three links, and a colour
+    if (_order)
+        size += sizeof (Order) + _order->size() * 5 * sizeof (void*);
+
+    return size;
+}
+
 inline
 std::size_t AssociationClass::Size() const
 {
@@ -108,13 +171,28 @@ LispObject* AssociationClass::GetElement(LispObject* k)
 inline
 void AssociationClass::SetElement(LispObject* k, LispObject* v)
 {
-    _map[Key(_env, LispPtr(k))] = v;
+    const auto p = _map.emplace(Key(_env, LispPtr(k)), v);
+
+    if (!p.second)
+        p.first->second = v;
+    else if (_order)
+        _order->insert(&*p.first);
 }
 
 inline
 bool AssociationClass::DropElement(LispObject* k)
 {
-    return _map.erase(Key(_env, LispPtr(k)));
+    const auto p = _map.find(Key(_env, LispPtr(k)));
+
+    if (p == _map.end())
+        return false;
+
+    if (_order)
+        _order->erase(&*p);
+
+    _map.erase(p);
+
+    return true;
 }
 
 #endif /* ASSOCIATIONCLASS_H */
@@ -0,0 +1,59 @@
+/** \file compiledbody.h
+ *  rule bodies compiled into trees of pre-resolved nodes.
+ */
+
+#ifndef YACAS_COMPILEDBODY_H
+#define YACAS_COMPILEDBODY_H
+
+#include "lispobject.h"
+#include "noncopyable.h"
+
+#include <memory>
+
+class LispEnvironment;
+
+/**
+ * An expression, typically the body or predicate of a rule, compiled
+ * into a tree of nodes that mirrors it. Each node knows up front what
+ * it is: a string constant, a variable, or a call, whose arguments
+ * are compiled in turn. A call resolves its function when first
+ * evaluated, and again only once a definition changed since, as seen
+ * from LispEnvironment::iRuleBaseGeneration. Calls of core functions
+ * evaluating their arguments, of user functions, and of If, While,
+ * Prog and Set are then evaluated by the node itself; anything else,
+ * macros included, is handed to the evaluator as it is.
+ *
+ * The nodes evaluate exactly as BasicEvaluator would, counting the
+ * evaluation depth and checking for interrupts the same way. Other
+ * evaluators, which trace or otherwise need to see every step, get
+ * the expression itself.
+ */
+class CompiledBody: NonCopyable {
+public:
+    /// Evaluate \a aExpression into \a aResult, as the evaluator of
+    /// \a aEnvironment would. Under BasicEvaluator, this goes through
+    /// \a aCompiled, compiled from \a aExpression on first use.
+    static void Eval(LispEnvironment& aEnvironment,
+                     LispPtr& aResult,
+                     LispPtr& aExpression,
+                     std::shared_ptr<CompiledBody>& aCompiled);
+
+    class Node;
+
+    explicit CompiledBody(LispPtr& aExpression);
+    ~CompiledBody();
+
+private:
+    /// Count one more level of evaluation, as BasicEvaluator::Eval()
+    /// does.
+    static void Enter(LispEnvironment& aEnvironment);
+
+    /// Compile \a aExpression, which must stay where it is.
+    static std::unique_ptr<Node> Compile(LispPtr& aExpression);
+
+    /// Keeps the nodes' expressions alive
+    LispPtr iExpression;
+    std::unique_ptr<Node> iRoot;
+};
+
+#endif
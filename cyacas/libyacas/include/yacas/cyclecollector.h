@@ -0,0 +1,74 @@
+/** \file cyclecollector.h
+ *  reclaiming containers that only reference each other.
+ */
+
+#ifndef YACAS_CYCLECOLLECTOR_H
+#define YACAS_CYCLECOLLECTOR_H
+
+#include "noncopyable.h"
+
+#include <cstddef>
+#include <unordered_set>
+
+class GenericClass;
+
+/**
+ * Trial deletion of cycles through containers.
+ * Reference counting cannot reclaim an array or association that,
+ * directly or through other containers and expressions, holds a
+ * reference to itself. The collector keeps track of such containers.
+ * Collect() walks everything reachable from them, and subtracts the
+ * references found on the way from the reference counts. Whatever is
+ * left with references from outside, and everything reachable from
+ * that, is in use. The containers that are not are emptied, which
+ * breaks the cycles, so that reference counting frees them.
+ *
+ * Objects holding references the collector does not see, such as
+ * patterns, count as referenced from outside, so nothing in use is
+ * ever freed.
+ */
+class CycleCollector: NonCopyable {
+public:
+    /// Figures of one collection
+    struct Statistics {
+        /// Groups of containers referencing each other
+        std::size_t cycles = 0;
+        std::size_t containers = 0;
+        /// Expressions held only by those containers
+        std::size_t objects = 0;
+        /// Memory of the containers and expressions, estimated
+        std::size_t bytes = 0;
+    };
+
+    CycleCollector();
+    ~CycleCollector();
+
+    /// Keep track of \a aClass, which holds references to expressions.
+    /// It is forgotten again when it is destroyed.
+    void Track(GenericClass* aClass);
+
+    /// Collect cycles every this many containers tracked, 0 for never
+    std::size_t iThreshold;
+
+    /// Whether iThreshold containers were tracked since the last Collect()
+    bool Due() const;
+
+    /// Free the containers that are only referenced from cycles.
+    Statistics Collect();
+
+private:
+    friend class GenericClass;
+
+    void Untrack(GenericClass* aClass);
+
+    std::unordered_set<GenericClass*> _tracked;
+    std::size_t _since;
+};
+
+inline
+bool CycleCollector::Due() const
+{
+    return iThreshold && _since >= iThreshold;
+}
+
+#endif
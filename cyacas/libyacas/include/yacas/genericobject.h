@@ -1,15 +1,35 @@
 #ifndef YACAS_GENERICOBJECT_H
 #define YACAS_GENERICOBJECT_H
 
+#include <cstddef>
+#include <vector>
+
+class CycleCollector;
+class LispObject;
+
 /// Abstract class which can be put inside a LispGenericClass.
 class GenericClass {
 public:
-    GenericClass() : iReferenceCount(0) {};
-    virtual ~GenericClass() = default;
+    GenericClass() : iReferenceCount(0), iCollector(nullptr) {};
+    virtual ~GenericClass();
     virtual const char* TypeName() const = 0;
+
+    /// Add the objects this holds references to to \a aObjects, for
+    /// the CycleCollector. Default behaviour is to add none.
+    virtual void References(std::vector<LispObject*>& /*aObjects*/) const {}
+    /// Drop the references to objects, done by the CycleCollector to
+    /// break a cycle. Default behaviour is to do nothing.
+    virtual void Clear() {}
+    /// Memory used besides the objects referenced, estimated
+    virtual std::size_t Footprint() const { return 0; }
 public:
     unsigned iReferenceCount; //TODO: perhaps share the method of reference counting with how it is done in other places
+
+private:
+    friend class CycleCollector;
+
+    /// Collector keeping track of this, or nullptr
+    CycleCollector* iCollector;
 };
 
 #endif
-
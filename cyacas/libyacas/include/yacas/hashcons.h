@@ -0,0 +1,88 @@
+/** \file hashcons.h
+ *  sharing of structurally equal expressions.
+ */
+
+#ifndef YACAS_HASHCONS_H
+#define YACAS_HASHCONS_H
+
+#include "lispobject.h"
+#include "noncopyable.h"
+
+#include <cstddef>
+#include <unordered_map>
+
+class LispEnvironment;
+
+/**
+ * Table of hash-consed list elements.
+ * An element of a list is the object together with the rest of the
+ * list it heads, its Nixed() chain. Cons() rebuilds an expression
+ * bottom-up out of elements from this table, so that elements which
+ * are structurally equal, including their rest, are the same object:
+ * equal lists share their elements, and lists ending alike share
+ * their tails. Every list it builds remembers its structural hash,
+ * InternalHash(), in LispObject::Hash(), so InternalEquals() tells
+ * lists with different hashes apart without walking them, and lists
+ * made of the same elements by comparing pointers.
+ *
+ * The elements are shared, so they must not be changed. They are
+ * marked, LispObject::Consed(), and the destructive list functions
+ * raise an error rather than relink any marked element. Lists taken
+ * from a hash-consed one, by Tail() for instance, are covered as well.
+ */
+class HashConsTable: NonCopyable {
+public:
+    HashConsTable();
+
+    /// Return the hash-consed equivalent of \a aExpression, or
+    /// \a aExpression itself if it contains generic objects.
+    LispPtr Cons(LispEnvironment& aEnvironment, const LispPtr& aExpression);
+
+    /// Number of elements in the table.
+    std::size_t Size() const;
+
+private:
+    struct Key {
+        int kind;
+        const void* payload;
+        const LispObject* next;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        LispPtr element;
+        /// Keeps the interned string a number is keyed on alive
+        LispStringSmartPtr number;
+    };
+
+    /// Hash-cons the elements of the list starting at \a aFirst.
+    /// \returns false if the list contains a generic object.
+    bool ConsList(LispEnvironment& aEnvironment,
+                  LispObject* aFirst,
+                  LispPtr& aResult);
+
+    /// Hash-cons a single element, with \a aNext as its rest.
+    bool ConsElement(LispEnvironment& aEnvironment,
+                     LispObject* aElement,
+                     const Entry& aNext,
+                     Entry& aResult);
+
+    /// Drop the elements nobody else uses any more.
+    void Collect();
+
+    std::unordered_map<Key, Entry, KeyHash> _elements;
+    /// Size of the table after the last Collect()
+    std::size_t _collected;
+};
+
+inline std::size_t HashConsTable::Size() const
+{
+    return _elements.size();
+}
+
+#endif
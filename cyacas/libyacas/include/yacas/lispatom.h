@@ -27,6 +27,9 @@
 #include "numbers.h"  // RefPtr<BigNumber> needs definition of BigNumber
 #include "noncopyable.h"
 
+#include <cstddef>
+#include <cstdint>
+
 /// This should be used whenever constants 2, 10 mean binary and decimal.
 // maybe move somewhere else?
 #ifdef YACAS_NO_CONSTEXPR
@@ -38,6 +41,7 @@ constexpr int BASE2 = 2;
 #endif
 
 class LispEnvironment;
+class EvalFuncBase;
 
 class LispAtom: public LispObject, public FastAlloc<LispAtom>
 {
@@ -51,6 +55,31 @@ private:
   LispStringSmartPtr iString;
 };
 
+//------------------------------------------------------------------------------
+// LispCallSite
+
+/// Monomorphic inline cache for the function a list evaluates to.
+/// BasicEvaluator::Eval remembers here the core command or user
+/// function the head of the list resolved to. The entry is only valid
+/// as long as #iGeneration equals LispEnvironment::iRuleBaseGeneration
+/// and the head of the list is unchanged. The arguments of a call never
+/// change in place, the destructive builtins only take lists, so the
+/// arity is counted once, when the entry is filled in.
+class LispCallSite {
+public:
+  LispCallSite() : iHead(nullptr), iArity(-1), iGeneration(0), iTarget(nullptr) {}
+
+  /// Name of the function the list called.
+  const LispString* iHead;
+  /// Number of arguments when the entry was filled in, or -1 if the
+  /// target does not depend on it.
+  int iArity;
+  /// Rule base generation the entry was filled in.
+  std::size_t iGeneration;
+  /// The resolved core command or user function.
+  const EvalFuncBase* iTarget;
+};
+
 //------------------------------------------------------------------------------
 // LispSublist
 
@@ -60,14 +89,22 @@ public:
   static LispSubList* New(LispObject* aSubList);
   ~LispSubList() override;
   LispPtr* SubList() override { return &iSubList; }
+  LispCallSite* CallSite() override { return &iCallSite; }
+  std::size_t Hash() const override { return iHash; }
   LispObject* Copy() const override { return new LispSubList(*this); }
 private:
   // Constructor is private -- use New() instead
-  LispSubList(LispObject* aSubList) : iSubList(aSubList) {}  // iSubList's constructor is messed up (it's a LispPtr, duh)
+  LispSubList(LispObject* aSubList) : iSubList(aSubList), iCallSite(), iHash(0) {}  // iSubList's constructor is messed up (it's a LispPtr, duh)
 public:
-  LispSubList(const LispSubList& other): LispObject(other), iSubList(other.iSubList) {}
+  LispSubList(const LispSubList& other): LispObject(other), iSubList(other.iSubList), iCallSite(other.iCallSite), iHash(other.iHash) {}
 private:
+  friend class HashConsTable;
+
   LispPtr iSubList;
+  LispCallSite iCallSite;
+  /// Structural hash of the elements if they are hash-consed, else 0.
+  /// Copies share the elements, so they keep the hash.
+  std::size_t iHash;
 };
 
 
@@ -102,22 +139,47 @@ class LispNumber: public LispObject, public FastAlloc<LispNumber>
 public:
     /// constructors:
     /// construct from another LispNumber
-  LispNumber(BigNumber* aNumber) : iNumber(aNumber), iString(nullptr) {}
-  LispNumber(const LispNumber& other) : LispObject(other), iNumber(other.iNumber), iString(other.iString) {}
+  LispNumber(BigNumber* aNumber) : iNumber(aNumber), iString(nullptr), iValue(0), iSmall(false) {}
+  LispNumber(const LispNumber& other) : LispObject(other), iNumber(other.iNumber), iString(other.iString), iValue(other.iValue), iSmall(other.iSmall) {}
   /// construct from a decimal string representation (also create a number object) and use aBasePrecision decimal digits
-  LispNumber(LispString * aString, int aBasePrecision) : iNumber(nullptr), iString(aString) { Number(aBasePrecision); }
+  LispNumber(LispString * aString, int aBasePrecision);
+  /// construct an integer that fits a machine word; no BigNumber object is created until one is asked for
+  explicit LispNumber(std::int64_t aValue) : iNumber(nullptr), iString(nullptr), iValue(aValue), iSmall(true) {}
 
   LispObject* Copy() const override { return new LispNumber(*this); }
   /// return a string representation in decimal with maximum decimal precision allowed by the inherent accuracy of the number
   LispString * String() override;
   /// give access to the BigNumber object; if necessary, will create a BigNumber object out of the stored string, at given precision (in decimal?)
   BigNumber* Number(int aPrecision) override;
+  bool IsNumber() const override { return true; }
+
+  /// If \a aObject is an integer held in a machine word, store it in \a aValue and return true.
+  static bool SmallInteger(const LispObject* aObject, std::int64_t& aValue);
 private:
   /// number object; nullptr if not yet converted from string
   RefPtr<BigNumber> iNumber;
   /// string representation in decimal; nullptr if not yet converted from BigNumber
   RefPtr<LispString> iString;
+  /// the value, if #iSmall
+  std::int64_t iValue;
+  /// the number is an integer that fits a machine word, kept in #iValue
+  bool iSmall;
 };
 
+inline bool LispNumber::SmallInteger(const LispObject* aObject, std::int64_t& aValue)
+{
+    // LispNumber is the only kind of object that is a number
+    if (!aObject->IsNumber())
+        return false;
+
+    const LispNumber* n = static_cast<const LispNumber*>(aObject);
+
+    if (!n->iSmall)
+        return false;
+
+    aValue = n->iValue;
+    return true;
+}
+
 
 #endif
@@ -7,7 +7,12 @@
 #define YACAS_LISPENVIRONMENT_H
 
 #include "lispobject.h"
+#include "argumentstack.h"
 #include "lisphash.h"
+#include "hashcons.h"
+#include "listindex.h"
+#include "cyclecollector.h"
+#include "memoryaccount.h"
 #include "lispevalhash.h"
 #include "lispuserfunc.h"
 #include "deffile.h"
@@ -104,6 +109,14 @@ public:
   void PushLocalFrame(bool aFenced);
   void PopLocalFrame();
   void NewLocal(const LispString* aVariable, LispObject* aValue);
+  /// Declare a local variable whose value is kept in \a aSlot, which
+  /// has to stay in place for as long as the variable exists.
+  void BindLocal(const LispString* aVariable, LispPtr* aSlot);
+  /// Return a mark for the local variables declared so far.
+  std::size_t LocalsMark() const;
+  /// Drop the local variables declared after \a aMark was taken.
+  /// They have to be in the current frame.
+  void PopLocals(std::size_t aMark);
   void CurrentLocals(LispPtr& aResult);
   void GlobalVariables(LispPtr& aResult);
   //@}
@@ -114,6 +127,8 @@ public:
 
   /// Return the #iCoreCommands attribute.
   const YacasCoreCommands& CoreCommands() const;
+  /// Return the core command \a aName, or nullptr if there is none.
+  const YacasEvaluator* CoreCommand(const LispString* aName) const;
   const LispUserFunctions& UserFunctions() const;
 
   /// Add a command to the list of core commands.
@@ -210,6 +225,25 @@ public:
   //DeletingLispCleanup iCleanup;
   int iEvalDepth;
   int iMaxEvalDepth;
+  /// Incremented whenever a core command, rule base or rule is
+  /// (re)defined or removed; invalidates all LispCallSite caches.
+  std::size_t iRuleBaseGeneration;
+  /// Incremented whenever a list is changed in place; invalidates all
+  /// ListIndexCache entries.
+  std::size_t iListGeneration;
+  /// Scratch stack for the values of pattern variables while a
+  /// pattern is being matched.
+  std::vector<LispPtr> iPatternBindings;
+  /// Hash-consed expressions, see HashCons()
+  HashConsTable iHashCons;
+  /// Elements of long lists, for Nth and Length
+  ListIndexCache iListIndex;
+  /// Arrays and associations, which may end up in cycles
+  CycleCollector iCycleCollector;
+  /// Arguments of the user function calls in progress
+  ArgumentStack iArgumentStack;
+  /// Memory used by evaluations in this environment
+  MemoryAccount iMemoryAccount;
 #ifdef YACAS_NO_ATOMIC_TYPES
   volatile bool
 #else
@@ -247,29 +281,48 @@ public: // Error reporting
 private:
     LispPtr *FindLocal(const LispString * aVariable);
 
+    /// Drop the local variables from \a first on, making the ones
+    /// they shadowed visible again.
+    void DropLocals(std::size_t first);
+
     struct LispLocalVariable {
         LispLocalVariable(const LispString* var, LispObject* val):
-            var(var), val(val)
+            var(var), val(val), slot(nullptr), shadowed(var->iSymbol.iLocal)
+        {
+        }
+
+        LispLocalVariable(const LispString* var, LispPtr* slot):
+            var(var), val(), slot(slot), shadowed(var->iSymbol.iLocal)
         {
         }
 
+        LispPtr* Value() { return slot ? slot : &val; }
 
         LispStringSmartPtr var;
         LispPtr val;
+        /// Where the value is kept if not in #val
+        LispPtr* slot;
+        /// LispSymbol::iLocal of #var before this variable was declared
+        std::size_t shadowed;
     };
 
     struct LocalVariableFrame {
-        LocalVariableFrame(std::size_t first, bool fenced):
-        first(first), fenced(fenced)
+        LocalVariableFrame(std::size_t first, bool fenced, std::size_t fence):
+        first(first), fenced(fenced), fence(fence)
         {
         }
 
         std::size_t first;
         bool fenced;
+        /// #_fence before this frame was pushed
+        std::size_t fence;
     };
 
     std::vector<LispLocalVariable> _local_vars;
     std::vector<LocalVariableFrame> _local_frames;
+    /// First local variable in the innermost fenced frame; the ones
+    /// below are not visible.
+    std::size_t _fence;
 
 public:
   std::ostream* iInitialOutput;
@@ -296,8 +349,8 @@ private:
 
   LispInput* iCurrentInput;
 
-  const LispString* iPrettyReader;
-  const LispString* iPrettyPrinter;
+  LispStringSmartPtr iPrettyReader;
+  LispStringSmartPtr iPrettyPrinter;
 public:
   LispTokenizer iDefaultTokenizer;
   XmlTokenizer  iXmlTokenizer;
@@ -323,6 +376,12 @@ inline const YacasCoreCommands& LispEnvironment::CoreCommands() const
     return iCoreCommands;
 }
 
+inline const YacasEvaluator*
+LispEnvironment::CoreCommand(const LispString* aName) const
+{
+    return aName ? aName->iSymbol.iCoreCommand : nullptr;
+}
+
 inline const LispUserFunctions& LispEnvironment::UserFunctions() const
 {
     return iUserFunctions;
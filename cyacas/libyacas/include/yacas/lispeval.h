@@ -9,6 +9,9 @@
 #include "lispobject.h"
 #include "lispenvironment.h"
 
+#include <memory>
+#include <vector>
+
 class UserStackInformation {
 public:
     UserStackInformation()
@@ -30,6 +33,15 @@ public:
   LispEvaluatorBase() : iBasicInfo() {}
   virtual ~LispEvaluatorBase() = default;
   virtual void Eval(LispEnvironment& aEnvironment, LispPtr& aResult, LispPtr& aExpression)=0;
+  /// Like Eval(), but the result may be the very object held by a
+  /// variable or by \a aExpression, rather than a copy. It must only
+  /// be looked at: not linked into a list, not returned as a result.
+  virtual void EvalShared(LispEnvironment& aEnvironment, LispPtr& aResult, LispPtr& aExpression);
+  /// Called when a user function is about to make the call
+  /// \a aExpression, the body of one of its rules, in its own place
+  /// rather than having it evaluated. Returns false if the call has to
+  /// go through Eval() after all.
+  virtual bool TailCall(LispEnvironment& aEnvironment, LispPtr& aExpression);
   virtual void ResetStack();
   virtual UserStackInformation& StackInformation();
   virtual void ShowStack(LispEnvironment& aEnvironment, std::ostream& aOutput);
@@ -66,7 +78,9 @@ public:
   ///     evaluator is called. Then it is checked agaist the list of
   ///     user function with GetUserFunction() . Again, the
   ///     corresponding evaluator is called if there is a check. If
-  ///     all fails, ReturnUnEvaluated() is called.
+  ///     all fails, ReturnUnEvaluated() is called. The lookup is done
+  ///     by ResolveCall(), which remembers its outcome in the
+  ///     LispCallSite of the list.
   ///   - Otherwise (ie. if \a aExpression is a generic object), it is
   ///     copied in \a aResult.
   ///
@@ -76,12 +90,28 @@ public:
   /// The LispPtr it can be stored in to is passed in as argument, so it
   /// does not need to be constructed by the calling environment.
   void Eval(LispEnvironment& aEnvironment, LispPtr& aResult, LispPtr& aExpression) override;
+
+  /// Atoms whose value, or which themselves, are not linked to a next
+  /// element are not copied; anything else goes through Eval().
+  void EvalShared(LispEnvironment& aEnvironment, LispPtr& aResult, LispPtr& aExpression) override;
+
+protected:
+  friend class CompiledBody;
+
+  /// Fail if the evaluation was interrupted or used up its memory.
+  void CheckInterrupt(LispEnvironment& aEnvironment);
+
+  /// Evaluate \a aExpression as Eval() does, once it is done checking.
+  void EvalStep(LispEnvironment& aEnvironment, LispPtr& aResult, LispPtr& aExpression);
 };
 
 class TracedEvaluator : public BasicEvaluator
 {
 public:
   void Eval(LispEnvironment& aEnvironment, LispPtr& aResult, LispPtr& aExpression) override;
+  void EvalShared(LispEnvironment& aEnvironment, LispPtr& aResult, LispPtr& aExpression) override;
+  /// The debugger is shown every call, so none is made in place.
+  bool TailCall(LispEnvironment& aEnvironment, LispPtr& aExpression) override;
 protected:
   std::ostringstream errorOutput;
 };
@@ -93,6 +123,9 @@ public:
   TracedStackEvaluator() : objs() {}
   ~TracedStackEvaluator() override;
   void Eval(LispEnvironment& aEnvironment, LispPtr& aResult, LispPtr& aExpression) override;
+  /// The frame of the caller is taken over by the call, which is what
+  /// the stack shows from then on.
+  bool TailCall(LispEnvironment& aEnvironment, LispPtr& aExpression) override;
   void ResetStack() override;
   UserStackInformation& StackInformation() override;
   void ShowStack(LispEnvironment& aEnvironment, std::ostream& aOutput) override;
@@ -105,12 +138,53 @@ private:
 
 
 
+/// Evaluator whose recursion is not bounded by the native stack.
+/// Evaluation starts on a stack segment allocated on the heap, and
+/// moves on to a new one whenever less than #RESERVE bytes of the
+/// current one are left, so that the evaluation depth is limited by
+/// the memory available only; MaxEvalDepth does not apply. The
+/// segments are kept for reuse until the evaluator is deleted.
+/// Where switching stacks is not supported, it evaluates as
+/// BasicEvaluator does.
+class SegmentedStackEvaluator final: public BasicEvaluator
+{
+public:
+  static constexpr std::size_t SEGMENT_SIZE = 1024 * 1024;
+  static constexpr std::size_t RESERVE = 128 * 1024;
+
+  SegmentedStackEvaluator();
+  ~SegmentedStackEvaluator() override;
+  void Eval(LispEnvironment& aEnvironment, LispPtr& aResult, LispPtr& aExpression) override;
+
+private:
+  /// Evaluate \a aExpression on a segment of its own.
+  void EvalOnSegment(LispEnvironment& aEnvironment, LispPtr& aResult, LispPtr& aExpression);
+
+  /// Entry point of a segment.
+  static void Run();
+
+  std::vector<std::unique_ptr<char[]>> iSegments;
+  /// Number of segments in use
+  std::size_t iDepth;
+  /// Lowest address the current segment is used down to before
+  /// moving on, nullptr if not on a segment
+  const char* iLimit;
+};
+
 /* GetUserFunction : get user function, possibly loading the required
    files to read in the function definition */
 LispUserFunction* GetUserFunction(LispEnvironment& aEnvironment,
                                   LispPtr* subList);
 
 
+/* ResolveCall : find the core command or user function the list
+   subList (the contents of aExpression) calls, using and updating the
+   LispCallSite cache of aExpression */
+const EvalFuncBase* ResolveCall(LispEnvironment& aEnvironment,
+                                LispObject* aExpression,
+                                LispPtr* subList);
+
+
 /* Tracing functions */
 void TraceShowEnter(LispEnvironment& aEnvironment,
                     LispPtr& aExpression);
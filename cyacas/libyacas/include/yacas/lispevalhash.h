@@ -23,7 +23,8 @@ public:
     Function=0,   // Function: evaluate arguments
     Macro=1,      // Function: don't evaluate arguments
     Fixed = 0,    // fixed number of arguments
-    Variable = 2  // variable number of arguments
+    Variable = 2, // variable number of arguments
+    Shared = 4    // arguments are only looked at, they need not be copies
   };
   YacasEvaluator(YacasEvalCaller aCaller,int aNrArgs, int aFlags)
     : iCaller(aCaller), iNrArgs(aNrArgs), iFlags(aFlags)
@@ -32,6 +33,11 @@ public:
   void Evaluate(LispPtr& aResult,
                 LispEnvironment& aEnvironment,
                 LispPtr& aArguments) const override;
+
+  YacasEvalCaller Caller() const { return iCaller; }
+  int NrArgs() const { return iNrArgs; }
+  int Flags() const { return iFlags; }
+
 private:
   YacasEvalCaller iCaller;
   int iNrArgs;
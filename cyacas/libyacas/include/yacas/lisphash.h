@@ -9,7 +9,9 @@
 
 #include "lispstring.h"
 
-#include <unordered_map>
+#include <cstddef>
+#include <string_view>
+#include <vector>
 
 /**
  * This is the symbol table, implemented as a hash table for fast
@@ -17,16 +19,87 @@
  * searching for strings and return a reference to the string.
  * This also allows fast comparison of two strings (two strings
  * are equal iff the pointers to the strings are equal).
+ *
+ * The table uses open addressing with linear probing. A slot holds
+ * the hash of the string next to the string itself, so that probing
+ * compares the bytes only when the hashes agree, and the bytes are
+ * stored once, in the LispString. Looking up a string that is
+ * already in the table does not allocate.
+ *
+ * Strings nobody else refers to any more are collected
+ * incrementally. Most strings die young (tokens of an expression
+ * typed once, strings built by Atomize or LocalSymbols), so the
+ * strings inserted since the last step are kept apart and all of
+ * them are looked at in the next step, while the rest of the table
+ * is swept a bounded number of slots per step.
  */
 class LispHashTable {
 public:
+    LispHashTable();
+
     // If string not yet in table, insert. Afterwards return the string.
-    const LispString* LookUp(const std::string&);
+    const LispString* LookUp(std::string_view);
+
+    /// Collect all strings nobody else refers to.
     void GarbageCollect();
 
+    /// Do a bounded amount of collecting, if enough strings were
+    /// inserted since the last time.
+    /// The strings returned by LookUp() are not reference counted, so
+    /// this may only be called where nobody holds on to one without
+    /// a LispStringSmartPtr.
+    void CollectIncrementally();
+
+    /// Number of strings in the table.
+    std::size_t Size() const;
+
+    /// Counts of the collector, since the table was created.
+    struct Statistics {
+        /// Strings inserted since the last step.
+        std::size_t young;
+        /// Strings disposed of.
+        std::size_t collected;
+        /// Strings that were still in use when they were looked at
+        /// in the young generation.
+        std::size_t retained;
+        /// Collection steps done.
+        std::size_t steps;
+    };
+
+    const Statistics& Stats() const;
+
 private:
-    std::unordered_map<std::string, LispStringSmartPtr> _rep;
+    struct Slot {
+        std::size_t hash;
+        LispStringSmartPtr string;
+    };
+
+    std::size_t Probe(std::size_t hash, std::string_view s) const;
+    void Rehash(std::size_t capacity);
+    void Remove(std::size_t i);
+
+    void CollectYoung();
+    void Sweep(std::size_t aSlots);
+
+    std::vector<Slot> _slots;
+    std::size_t _size;
+
+    /// Strings inserted since the last step.
+    std::vector<const LispString*> _young;
+    /// Slot where the sweep of the table continues.
+    std::size_t _cursor;
+
+    Statistics _stats;
 };
 
+inline std::size_t LispHashTable::Size() const
+{
+    return _size;
+}
+
+inline const LispHashTable::Statistics& LispHashTable::Stats() const
+{
+    return _stats;
+}
 
 #endif
@@ -18,8 +18,11 @@
 #include "genericobject.h"
 #include "noncopyable.h"
 
+#include <cstddef>
+
 class LispObject;
 class BigNumber;
+class LispCallSite;
 
 
 /** class LispPtr. A LispPtr is a smart pointer to a LispObject.
@@ -43,7 +46,7 @@ public:
   inline LispPtr& Nixed();
 
 public: //Derivables
-  virtual ~LispObject() = default;
+  virtual ~LispObject();
 
   /** Return string representation, or nullptr if the object doesn't have one.
    *  the string representation is only relevant if the object is a
@@ -59,6 +62,28 @@ public: //Derivables
   /** If this is a number, return a BigNumber representation
    */
   virtual BigNumber* Number(int aPrecision) { return nullptr; }
+  /** Return true if this is a number. Unlike Number(), this never
+   *  converts anything. Default behaviour is to return false.
+   */
+  virtual bool IsNumber() const { return false; }
+
+  /** If this object can be evaluated as a function call, return the
+   *  cache remembering which function it resolved to last time.
+   *  Default behaviour is to return nullptr.
+   */
+  virtual LispCallSite* CallSite() { return nullptr; }
+
+  /** If this is a list built by HashConsTable, return the structural
+   *  hash of its elements, computed when it was built. Equal lists
+   *  have equal hashes. Default behaviour is to return 0, unknown.
+   */
+  virtual std::size_t Hash() const { return 0; }
+
+  /** Whether this is an element of a HashConsTable, shared by all the
+   *  lists equal to the one it heads: neither it nor its rest may be
+   *  changed. Copies are not elements.
+   */
+  bool Consed() const { return iConsed; }
 
   virtual LispObject* Copy() const = 0;
 
@@ -68,11 +93,11 @@ public:
   inline int operator!=(LispObject& aOther);
 protected:
   inline LispObject() :
-   iNext()
+   iConsed(false), iNext()
   {
   }
   inline LispObject(const LispObject& other) :
-  iNext()
+  iConsed(false), iNext()
   {
   }
 
@@ -83,9 +108,33 @@ protected:
 
 
 private:
+  friend class HashConsTable;
+
+  bool      iConsed;
   LispPtr   iNext;
 };
 
+/** class LispReclaimer takes apart the objects whose last reference
+ *  goes away. An object dying while another one is being taken apart,
+ *  the rest of a list or the contents of a sublist, is put on a
+ *  worklist of the thread instead of being destroyed right away, so
+ *  that long and deeply nested expressions are destroyed iteratively
+ *  rather than recursively. One release destroys at most SLICE
+ *  objects, the remainder waits for the next releases, or for the
+ *  next top-level evaluation: dropping a huge expression does not
+ *  stall the one dropping it.
+ */
+class LispReclaimer {
+public:
+  static const std::size_t SLICE = 1 << 14;
+
+  /// Release \a aObject, which must not be nullptr, and set it to nullptr.
+  static void Release(LispPtr& aObject) noexcept;
+  /// Destroy at most \a aCount waiting objects, return the number
+  /// still waiting.
+  static std::size_t Collect(std::size_t aCount) noexcept;
+};
+
 /**
  * class LispIterator works almost like LispPtr, but doesn't enforce
  * reference counting, so it should be faster.  Use LispIterator
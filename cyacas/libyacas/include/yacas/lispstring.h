@@ -8,8 +8,43 @@
 
 #include "refcount.h"
 
+#include <cstddef>
 #include <string>
 
+class LispGlobalVariable;
+class LispMultiUserFunction;
+class YacasEvaluator;
+
+/// What a symbol stands for in LispEnvironment.
+/// The pointers point into the tables of the environment, which own
+/// the entries; the environment keeps them up to date, so that
+/// looking up a symbol needs no hashing.
+class LispSymbol {
+public:
+    LispSymbol();
+
+    /// One past the position of the innermost local variable with
+    /// this name, or 0 if there is none.
+    std::size_t iLocal;
+    /// The global variable, or nullptr.
+    LispGlobalVariable* iGlobal;
+    /// The core command, or nullptr.
+    const YacasEvaluator* iCoreCommand;
+    /// The user functions, or nullptr.
+    LispMultiUserFunction* iUserFunction;
+    /// Whether the symbol is protected.
+    bool iProtected;
+};
+
+inline LispSymbol::LispSymbol():
+    iLocal(0),
+    iGlobal(nullptr),
+    iCoreCommand(nullptr),
+    iUserFunction(nullptr),
+    iProtected(false)
+{
+}
+
 /** \class LispString : zero-terminated byte-counted string.
  * Also keeps a reference count for any one interested.
  */
@@ -17,12 +52,45 @@ class LispString: public RefCount, public std::string
 {
 public:
     explicit LispString(const std::string& = "");
+    LispString(const LispString&);
+    LispString& operator=(const LispString&);
+    ~LispString();
+
+    /// Meaning of the string as a symbol. Belongs to the environment,
+    /// it is not copied with the string.
+    mutable LispSymbol iSymbol;
+
+private:
+    /// Charge the MemoryAccount for the current size of the string
+    void Charge();
+
+    /// Bytes the MemoryAccount was charged for
+    std::size_t iCharged;
 };
 
 
 inline LispString::LispString(const std::string& s):
-    std::string(s)
+    std::string(s),
+    iSymbol(),
+    iCharged(0)
+{
+    Charge();
+}
+
+inline LispString::LispString(const LispString& s):
+    RefCount(),
+    std::string(s),
+    iSymbol(),
+    iCharged(0)
+{
+    Charge();
+}
+
+inline LispString& LispString::operator=(const LispString& s)
 {
+    std::string::operator=(s);
+    Charge();
+    return *this;
 }
 
 typedef RefPtr<const LispString> LispStringSmartPtr;
@@ -0,0 +1,55 @@
+/** \file listindex.h
+ *  constant time access to the elements of long lists.
+ */
+
+#ifndef YACAS_LISTINDEX_H
+#define YACAS_LISTINDEX_H
+
+#include "lispobject.h"
+#include "noncopyable.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Index of the elements of recently used long lists, so that finding
+ * an element by position, or the length, takes constant time.
+ * A list is known by its first element, which all copies of the list
+ * share. Its entry is filled in the second time the list is walked,
+ * and stays valid as long as the generation it was filled in equals
+ * LispEnvironment::iListGeneration, which every change of a list in
+ * place increments.
+ */
+class ListIndexCache: NonCopyable {
+public:
+    /// Element \a n of the list starting with \a aFirst, or nullptr if
+    /// the list is shorter.
+    LispObject* Element(std::size_t aGeneration,
+                        const LispPtr& aFirst,
+                        std::size_t n);
+
+    /// Number of elements of the list starting with \a aFirst.
+    std::size_t Size(std::size_t aGeneration, const LispPtr& aFirst);
+
+private:
+    struct Entry {
+        std::size_t generation = 0;
+        /// Keeps the list alive, so that its address is not reused
+        LispPtr first;
+        /// Empty until the list is walked the second time
+        std::vector<LispObject*> elements;
+    };
+
+    /// The entry of the list, if filled in
+    const Entry* Find(std::size_t aGeneration, const LispPtr& aFirst) const;
+
+    /// Note that the list is walked; returns its entry from the second
+    /// time on
+    const Entry* Walk(std::size_t aGeneration, const LispPtr& aFirst);
+
+    static const std::size_t SLOTS = 256;
+
+    Entry _entries[SLOTS];
+};
+
+#endif
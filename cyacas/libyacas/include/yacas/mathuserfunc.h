@@ -1,10 +1,14 @@
 #ifndef YACAS_MATHUSERFUNC_H
 #define YACAS_MATHUSERFUNC_H
 
+#include "compiledbody.h"
 #include "lispuserfunc.h"
+#include "memotable.h"
 #include "patternclass.h"
 #include "noncopyable.h"
 
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 /// A mathematical function defined by several rules.
@@ -32,6 +36,15 @@ public:
     virtual bool Matches(LispEnvironment& aEnvironment, LispPtr* aArguments) = 0;
     virtual int Precedence() const = 0;
     virtual LispPtr& Body() = 0;
+    /// Structural requirement on argument \a aParameter; rules that
+    /// can not tell return PatternKey::Any.
+    virtual PatternKey Key(std::size_t /*aParameter*/) const { return PatternKey(); }
+
+    /// Evaluate Body() into \a aResult, compiled once evaluated.
+    void EvalBody(LispEnvironment& aEnvironment, LispPtr& aResult);
+
+  private:
+    std::shared_ptr<CompiledBody> iCompiledBody;
   };
 
   /// A rule with a predicate.
@@ -59,6 +72,7 @@ public:
     int iPrecedence;
     LispPtr iBody;
     LispPtr iPredicate;
+    std::shared_ptr<CompiledBody> iCompiledPredicate;
   };
 
   /// A rule that always matches.
@@ -97,6 +111,9 @@ public:
     /// Access #iPrecedence
     int Precedence() const;
 
+    /// Ask #iPatternClass for the structure of argument \a aParameter.
+    PatternKey Key(std::size_t aParameter) const override;
+
     /// Access #iBody
     LispPtr& Body();
 
@@ -130,15 +147,25 @@ public:
   ///
   /// First, all arguments are evaluated by the evaluator associated
   /// to \a aEnvironment, unless the \c iHold flag of the
-  /// corresponding parameter is true. Then a new LispLocalFrame is
-  /// constructed, in which the actual arguments are assigned to the
-  /// names of the formal arguments, as stored in \c iParameter. Then
+  /// corresponding parameter is true, into a frame of the
+  /// ArgumentStack. Then a new LispLocalFrame is constructed, in
+  /// which the names of the formal arguments, as stored in
+  /// \c iParameter, are bound to the slots of the actual ones. Then
   /// all rules in #iRules are tried one by one. The body of the
   /// first rule that matches is evaluated, and the result is put in
   /// \a aResult. If no rule matches, \a aResult will recieve a new
   /// expression with evaluated arguments.
   void Evaluate(LispPtr& aResult,LispEnvironment& aEnvironment, LispPtr& aArguments) const override;
 
+  /// Evaluate the function on the call \a aArguments as Evaluate()
+  /// does, with the arguments evaluated into \a aValues already.
+  /// A traced function is to be called through Evaluate(), which
+  /// shows the call entered before evaluating the arguments.
+  void Apply(LispPtr& aResult, LispEnvironment& aEnvironment, LispPtr& aArguments, ArgumentStack::Frame& aValues) const;
+
+  /// Return true if parameter \a aParameter is on hold.
+  bool Held(std::size_t aParameter) const;
+
   /// Put an argument on hold.
   /// \param aVariable name of argument to put un hold
   ///
@@ -174,6 +201,63 @@ public:
   /// Return the argument list, stored in #iParamList
   const LispPtr& ArgList() const override;
 
+  /// Remember the results of the function from now on. The results
+  /// are forgotten whenever a rule is added.
+  void Memoize();
+
+  /// Return the results remembered, or nullptr if not memoized.
+  MemoTable* Memo() const;
+
+protected:
+  /// Evaluate the function as Evaluate() does. With \a aListed, the
+  /// last parameter takes the list of the remaining arguments.
+  void Call(LispPtr& aResult, LispEnvironment& aEnvironment, LispPtr& aArguments, bool aListed) const;
+
+  /// Evaluate the arguments of the call \a aArguments into \a aValues,
+  /// one per parameter, unless the parameter is on hold.
+  void EvaluateArguments(LispEnvironment& aEnvironment, LispPtr& aArguments, LispPtr* aValues, bool aListed) const;
+
+  /// Return the function called by the rule body \a aBody if the call
+  /// can take over the local frame and the \a aSlots argument slots
+  /// of the current one, rather than being evaluated on top of them.
+  /// Returns nullptr if the body is to be evaluated as usual.
+  const BranchingUserFunction* TailCall(LispEnvironment& aEnvironment, LispPtr& aBody, std::size_t aSlots) const;
+
+  /// Discrimination index over #iRules.
+  /// The rules are bucketed on the PatternKey they require for the
+  /// single most selective argument. For an actual argument, the
+  /// bucket holds exactly the rules that can possibly match it
+  /// structurally, in the same order as in #iRules.
+  class RuleIndex {
+  public:
+    RuleIndex(const std::vector<BranchRuleBase*>& aRules, std::size_t aParameter);
+
+    /// Return the rules that may match \a aArguments.
+    const std::vector<BranchRuleBase*>& Candidates(LispPtr* aArguments) const;
+
+  private:
+    typedef std::unordered_map<const LispString*, std::vector<BranchRuleBase*> > Buckets;
+
+    std::size_t iParameter;
+    std::vector<BranchRuleBase*> iAny;
+    std::vector<BranchRuleBase*> iNumbers;
+    std::vector<BranchRuleBase*> iLists;
+    Buckets iAtoms;
+    Buckets iListHeads;
+  };
+
+  /// Return the rule index, building it if needed. Returns nullptr
+  /// if no argument discriminates between the rules.
+  std::shared_ptr<const RuleIndex> Index() const;
+
+  /// Return the first rule in #iRules matching \a aArguments, or
+  /// nullptr if none does. Only the candidates from Index() are
+  /// tried.
+  BranchRuleBase* MatchingRule(LispEnvironment& aEnvironment, LispPtr* aArguments) const;
+
+  /// Try the rules in #iRules linearly, starting at \a aFirst.
+  BranchRuleBase* MatchingRule(LispEnvironment& aEnvironment, LispPtr* aArguments, std::size_t aFirst) const;
+
 protected:
   /// List of arguments, with corresponding \c iHold property.
   std::vector<BranchParameter> iParameters;
@@ -183,6 +267,13 @@ protected:
 
   /// List of arguments
   LispPtr iParamList;
+
+  /// Lazily built index over #iRules, reset by InsertRule().
+  mutable std::shared_ptr<const RuleIndex> iIndex;
+  mutable bool iIndexed;
+
+  /// Results of earlier calls, if memoized.
+  std::unique_ptr<MemoTable> iMemo;
 };
 
 class ListedBranchingUserFunction final: public BranchingUserFunction
@@ -199,6 +290,22 @@ class MacroUserFunction : public BranchingUserFunction
 public:
   MacroUserFunction(LispPtr& aParameters);
   void Evaluate(LispPtr& aResult,LispEnvironment& aEnvironment, LispPtr& aArguments) const override;
+
+protected:
+  void Call(LispPtr& aResult, LispEnvironment& aEnvironment, LispPtr& aArguments, bool aListed) const;
+
+private:
+  /// Table of the expansions of the body of \a aRule, or nullptr if
+  /// its expansion depends on more than the arguments.
+  MemoTable* Expansions(BranchRuleBase& aRule) const;
+
+  /// Whether substituting into \a aElement, as BackQuoteBehaviour
+  /// does, evaluates nothing but parameters.
+  bool OnlyParameters(LispObject* aElement) const;
+
+  /// Expansions of the rules' bodies, keyed on the arguments. A rule
+  /// defined anew is a new rule, so its expansions start afresh.
+  mutable std::unordered_map<const BranchRuleBase*, std::unique_ptr<MemoTable>> iExpansions;
 };
 
 
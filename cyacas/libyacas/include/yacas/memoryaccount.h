@@ -0,0 +1,92 @@
+/** \file memoryaccount.h
+ *  keeping track of the memory used on behalf of an environment.
+ */
+
+#ifndef YACAS_MEMORYACCOUNT_H
+#define YACAS_MEMORYACCOUNT_H
+
+#include "noncopyable.h"
+
+#include <cstddef>
+
+/**
+ * Bytes in use on behalf of one environment.
+ * While a Scope is alive, the calling thread charges the account for
+ * the memory it takes: the slabs of the memory pools, the limbs of
+ * big integers and strings. Memory given back is credited to
+ * whichever account is charged at that point, so memory that outlives
+ * the evaluation that took it is still counted.
+ *
+ * The memory is attributed per thread, not per environment. The
+ * memory pools belong to the thread and are shared by all environments
+ * evaluating on it: a slab is charged in full to the account active
+ * when it is taken, and environments evaluating on the same thread
+ * later fill it without being charged. With one environment per
+ * thread, the figures are exact up to the size of a slab. Environments
+ * sharing a thread are charged for each other's memory, so their
+ * limits do not keep them apart, and an account credited for memory
+ * another one was charged for drops below zero, which Current()
+ * reports as 0.
+ *
+ * Once the usage grows past the limit, iExceeded is set and the next
+ * evaluation step fails with LispErrNotEnoughMemory. It is set again
+ * only after the usage has dropped below the limit.
+ */
+class MemoryAccount: NonCopyable {
+public:
+    /// Charges \a aAccount for what the calling thread takes for the
+    /// lifetime of the scope. Scopes may nest, the innermost one counts.
+    class Scope: NonCopyable {
+    public:
+        explicit Scope(MemoryAccount& aAccount);
+        ~Scope() noexcept;
+
+    private:
+        MemoryAccount* _previous;
+    };
+
+    MemoryAccount();
+
+    /// Charge the account of the calling thread, if any, for \a aBytes
+    /// taken, or credit it for as many given back if negative.
+    static void Charge(std::ptrdiff_t aBytes) noexcept;
+
+    /// Bytes in use
+    std::size_t Current() const;
+    /// Most bytes in use at any time
+    std::size_t Peak() const;
+
+    /// Bytes beyond which evaluation fails, 0 for no limit
+    std::size_t Limit() const;
+    void SetLimit(std::size_t aBytes);
+
+    /// Whether the usage grew past the limit; cleared by the check
+    bool iExceeded;
+
+private:
+    std::ptrdiff_t _current;
+    std::ptrdiff_t _peak;
+    std::ptrdiff_t _limit;
+    /// Whether growing past the limit sets iExceeded
+    bool _armed;
+};
+
+inline
+std::size_t MemoryAccount::Current() const
+{
+    return _current > 0 ? _current : 0;
+}
+
+inline
+std::size_t MemoryAccount::Peak() const
+{
+    return _peak;
+}
+
+inline
+std::size_t MemoryAccount::Limit() const
+{
+    return _limit;
+}
+
+#endif
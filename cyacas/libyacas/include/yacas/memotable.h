@@ -0,0 +1,117 @@
+/** \file memotable.h
+ *  remembering the results of a pure user function.
+ */
+
+#ifndef YACAS_MEMOTABLE_H
+#define YACAS_MEMOTABLE_H
+
+#include "lispobject.h"
+#include "noncopyable.h"
+
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+class LispEnvironment;
+
+/**
+ * Results of a memoized user function, keyed on its evaluated
+ * arguments and the precision they were evaluated at.
+ * Arguments are looked up by their structural hash, InternalHash(),
+ * and compared strictly: numbers match when their digits are the
+ * same, so that 2 and 2.0 are told apart, atoms and strings when they
+ * are the same unique string. Arguments containing generic
+ * objects, which cannot be compared, are never remembered. Neither
+ * the arguments nor the results share a list with the calls they come
+ * from or go to, see DeepCopy(), so that the destructive list
+ * functions cannot change what the table holds. Once the table holds
+ * its capacity, the least recently used result makes way for a new
+ * one.
+ */
+class MemoTable: NonCopyable {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 1024;
+
+    /// Arguments of a call the result is not known for yet
+    struct Key {
+        std::size_t hash = 0;
+        int precision = 0;
+        std::vector<LispPtr> arguments;
+        /// Value of the table's generation when the key was made
+        std::size_t generation = 0;
+        /// Whether Find() filled in the key
+        bool filled = false;
+    };
+
+    MemoTable();
+
+    /// Look up the result for the \a aSize arguments \a aArguments.
+    /// Returns nullptr if it is not known, after filling in \a aKey,
+    /// unless the arguments cannot be remembered.
+    const LispPtr* Find(LispEnvironment& aEnvironment,
+                        const LispPtr* aArguments,
+                        std::size_t aSize,
+                        Key& aKey);
+
+    /// Remember \a aResult for \a aKey, if filled in by Find().
+    /// Results of keys made before the last Clear() are dropped.
+    void Insert(Key& aKey, const LispPtr& aResult);
+
+    /// Forget all results
+    void Clear();
+
+    /// Copy \a aExpression down to its atoms, so that the copy shares
+    /// no list with it
+    static LispObject* DeepCopy(LispObject* aExpression);
+
+    std::size_t Capacity() const;
+    void SetCapacity(std::size_t aCapacity);
+
+    std::size_t Size() const;
+    std::size_t Hits() const;
+    std::size_t Misses() const;
+
+private:
+    struct Entry {
+        Key key;
+        LispPtr result;
+    };
+
+    typedef std::list<Entry> Entries;
+
+    /// Drop the least recently used results down to \a aSize
+    void Evict(std::size_t aSize);
+
+    /// Most recently used first
+    Entries _entries;
+    std::unordered_multimap<std::size_t, Entries::iterator> _index;
+
+    std::size_t _capacity;
+    std::size_t _generation;
+    std::size_t _hits;
+    std::size_t _misses;
+};
+
+inline std::size_t MemoTable::Capacity() const
+{
+    return _capacity;
+}
+
+inline std::size_t MemoTable::Size() const
+{
+    return _entries.size();
+}
+
+inline std::size_t MemoTable::Hits() const
+{
+    return _hits;
+}
+
+inline std::size_t MemoTable::Misses() const
+{
+    return _misses;
+}
+
+#endif
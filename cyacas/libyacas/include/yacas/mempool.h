@@ -3,29 +3,66 @@
 
 #include "noncopyable.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 
+/// Allocator for blocks of one size, used by one thread.
+/// The blocks are carved from slabs of SLAB_SIZE bytes, aligned to
+/// their size, so that the slab a block belongs to follows from the
+/// address of the block. A block freed by the thread owning its slab
+/// goes straight back to the slab; a block freed by another thread is
+/// pushed onto a lock-free list of the slab, and the first such block
+/// puts the slab on a list of the owner. When its slab runs out of
+/// blocks, the owner takes over the blocks of the slabs on that list
+/// and moves on to one of the slabs it knows to have room, so that
+/// this takes no longer with more slabs. Slabs with no blocks in use
+/// are given back to the operating system.
+///
+/// Slabs taken and given back are charged to the MemoryAccount of the
+/// thread.
 class MemPool: NonCopyable {
 public:
-    explicit MemPool(unsigned block_size, unsigned no_blocks);
+    static const std::size_t SLAB_SIZE = 64 * 1024;
+
+    struct Slab;
+
+    /// Slabs of pools of threads that have ended, while some of their
+    /// blocks were still in use. The first pool of the same block
+    /// size that runs out of blocks adopts them.
+    struct Depot {
+        std::mutex lock;
+        Slab* slabs = nullptr;
+    };
+
+    MemPool(unsigned block_size, Depot& depot);
     ~MemPool() noexcept;
 
     void* alloc();
     void free(void *p) noexcept;
 
 private:
-    unsigned _block_size;
-    unsigned _no_blocks;
+    Slab* NewSlab();
+    Slab* Adopt();
+    void Take(Slab* slab);
+    void Release(Slab* slab) noexcept;
+    void Open(Slab* slab) noexcept;
+    void Close(Slab* slab) noexcept;
+    void Notify(Slab* slab) noexcept;
+    bool Refill();
 
-    unsigned _no_free_blocks;
-    unsigned _no_initialized_blocks;
+    unsigned _block_size;
+    Depot& _depot;
 
-    std::uint8_t* _pool;
-    
-    std::uint8_t* _next_free_block;
-    
-    MemPool* _next_pool;
+    /// Slab blocks are allocated from
+    Slab* _current;
+    /// All slabs of this pool, including #_current
+    Slab* _slabs;
+    /// Slabs with room other than #_current
+    Slab* _open;
+    /// Slabs other threads returned blocks to since the last Refill()
+    std::atomic<Slab*> _returned;
 };
 
 template <typename T>
@@ -34,10 +71,14 @@ public:
     static void* operator new(std::size_t size) { return _pool.alloc(); }
     static void operator delete(void* p) { _pool.free(p); }
 private:
-    static MemPool _pool;
+    static MemPool::Depot _depot;
+    static thread_local MemPool _pool;
 };
 
 template <typename T>
-MemPool FastAlloc<T>::_pool(sizeof (T), 32768);
+MemPool::Depot FastAlloc<T>::_depot;
+
+template <typename T>
+thread_local MemPool FastAlloc<T>::_pool(sizeof (T), FastAlloc<T>::_depot);
 
 #endif
@@ -43,6 +43,11 @@ public: //constructors
 
     //basic object manipulation
     bool Equals(const BigNumber& aOther) const;
+    /// Hash, the same for numbers Equals() takes for equal, except for
+    /// floats that differ in the last of the leading bits they are
+    /// hashed on, and for floats equal to an integer of more than 53 bits
+    /// only up to the precision
+    std::size_t Hash() const;
     bool IsInt() const;
     bool IsSmall() const;
     void BecomeInt();
@@ -20,6 +20,8 @@ public:
   bool Matches(LispEnvironment& aEnvironment,
                       LispPtr* aArguments);
 
+  PatternKey Key(std::size_t aParameter) const;
+
   const char* TypeName() const override;
 
 protected:
@@ -20,113 +20,61 @@
 
 #include <vector>
 
-/// Abstract class for matching one argument to a pattern.
-class YacasParamMatcherBase {
+/// Coarse structural class of an expression.
+/// Used to index rules on what an argument has to look like for the
+/// rule to possibly match, without running the full pattern matcher.
+class PatternKey {
 public:
-    /// Destructor.
-    virtual ~YacasParamMatcherBase() = default;
-
-    /// Check whether some expression matches to the pattern.
-    /// \param aEnvironment the underlying Lisp environment.
-    /// \param aExpression the expression to test.
-    /// \param arguments (input/output) actual values of the pattern
-    /// variables for \a aExpression.
-    virtual bool ArgumentMatches(LispEnvironment& aEnvironment,
-                                 LispPtr& aExpression,
-                                 LispPtr* arguments) const = 0;
-};
-
-/// Class for matching an expression to a given atom.
-class MatchAtom : public YacasParamMatcherBase
-{
-public:
-    explicit MatchAtom(const LispString* aString);
-    bool ArgumentMatches(LispEnvironment& aEnvironment,
-                         LispPtr& aExpression,
-                         LispPtr* arguments) const override;
-protected:
-    const LispString* iString;
-};
-
-inline
-MatchAtom::MatchAtom(const LispString* aString):
-    iString(aString)
-{
-}
-
-/// Class for matching an expression to a given number.
-class MatchNumber : public YacasParamMatcherBase
-{
-public:
-    explicit MatchNumber(BigNumber* aNumber);
-    bool ArgumentMatches(LispEnvironment& aEnvironment,
-                         LispPtr& aExpression,
-                         LispPtr* arguments) const override;
-protected:
-    RefPtr<BigNumber> iNumber;
-};
-
-inline
-MatchNumber::MatchNumber(BigNumber* aNumber):
-    iNumber(aNumber)
-{
-}
+    enum Kind {
+        Any,    ///< no structural requirement (or a generic object)
+        Atom,   ///< an atom named #iHead
+        Number, ///< a number
+        List    ///< a list whose head is the atom #iHead, or any list if #iHead is nullptr
+    };
 
-/// Class for matching against a list of YacasParamMatcherBase objects.
-class MatchSubList final: public YacasParamMatcherBase, NonCopyable {
-public:
-    explicit MatchSubList(const std::vector<const YacasParamMatcherBase*>&& aMatchers);
-    ~MatchSubList() override;
+    explicit PatternKey(Kind aKind = Any, const LispString* aHead = nullptr);
 
-    bool ArgumentMatches(
-        LispEnvironment& aEnvironment,
-        LispPtr& aExpression,
-        LispPtr* arguments) const override;
+    /// Return the key of an actual argument.
+    static PatternKey Of(LispObject* aExpression);
 
-protected:
-    std::vector<const YacasParamMatcherBase*> iMatchers;
+    Kind iKind;
+    const LispString* iHead;
 };
 
 inline
-MatchSubList::MatchSubList(const std::vector<const YacasParamMatcherBase*>&& aMatchers):
-    iMatchers(aMatchers)
-{
-}
-
-inline
-MatchSubList::~MatchSubList()
+PatternKey::PatternKey(Kind aKind, const LispString* aHead):
+    iKind(aKind), iHead(aHead)
 {
-    for (const YacasParamMatcherBase* m: iMatchers)
-        delete m;
 }
 
-/// Class for matching against a pattern variable.
-class MatchVariable final: public YacasParamMatcherBase
-{
+/// One instruction of a compiled pattern.
+/// A pattern is compiled into a flat sequence of instructions per
+/// function parameter. The instructions are run in order against a
+/// cursor into the argument; every instruction except Leave consumes
+/// the element under the cursor and moves it to the next one. The
+/// first instruction that fails ends the match.
+class PatternInstruction {
 public:
-    explicit MatchVariable(int aVarIndex);
-
-    /// Matches an expression against the pattern variable.
-    /// \param aEnvironment the underlying Lisp environment.
-    /// \param aExpression the expression to test.
-    /// \param arguments (input/output) actual values of the pattern
-    /// variables for \a aExpression.
-    ///
-    /// If entry #iVarIndex in \a arguments is still empty, the
-    /// pattern matches and \a aExpression is stored in this
-    /// entry. Otherwise, the pattern only matches if the entry equals
-    /// \a aExpression.
-    bool ArgumentMatches(LispEnvironment& aEnvironment,
-                         LispPtr& aExpression,
-                         LispPtr* arguments) const override;
-protected:
-    /// Index of variable in YacasPatternPredicateBase::iVariables.
-    int iVarIndex;
+    enum OpCode {
+        Atom,     ///< the element is the (non-numeric) atom #iString
+        Number,   ///< the element is a number equal to #iNumber
+        Variable, ///< bind the element to pattern variable #iIndex, or
+                  ///< compare with the value bound to it before
+        Enter,    ///< the element is a list; move into it
+        Leave     ///< the list is exhausted; move back out of it
+    };
+
+    explicit PatternInstruction(OpCode aOpCode);
+
+    OpCode iOpCode;
+    int iIndex;
+    LispStringSmartPtr iString;
+    RefPtr<BigNumber> iNumber;
 };
 
 inline
-MatchVariable::MatchVariable(int aVarIndex):
-    iVarIndex(aVarIndex)
+PatternInstruction::PatternInstruction(OpCode aOpCode):
+    iOpCode(aOpCode), iIndex(-1), iString(nullptr), iNumber(nullptr)
 {
 }
 
@@ -142,27 +90,27 @@ public:
     /// \param aPostPredicate Lisp expression containing the
     /// postpredicate
     ///
-    /// The function MakePatternMatcher() is called for every argument
-    /// in \a aPattern, and the resulting pattern matchers are
-    /// collected in #iParamMatchers. Additionally, \a aPostPredicate
+    /// The function Compile() is called for every argument in
+    /// \a aPattern, filling #iProgram and #iParameters. Additionally, \a aPostPredicate
     /// is copied, and the copy is added to #iPredicates.
     YacasPatternPredicateBase(LispEnvironment& aEnvironment,
                               LispPtr& aPattern,
                               LispPtr& aPostPredicate);
 
     /// Destructor.
-    virtual ~YacasPatternPredicateBase();
+    virtual ~YacasPatternPredicateBase() = default;
 
     /// Try to match the pattern against \a aArguments.
-    /// First, every argument in \a aArguments is matched against the
-    /// corresponding YacasParamMatcherBase in #iParamMatches. If any
-    /// match fails, Matches() returns false. Otherwise, a temporary
-    /// LispLocalFrame is constructed, then SetPatternVariables() and
-    /// CheckPredicates() are called, and then the LispLocalFrame is
-    /// immediately deleted. If CheckPredicates() returns false, this
-    /// function also returns false. Otherwise, SetPatternVariables()
-    /// is called again, but now in the current LispLocalFrame, and
-    /// this function returns true.
+    /// First, the instructions in #iProgram for every parameter are
+    /// run on the corresponding argument in \a aArguments, collecting
+    /// the values of the pattern variables on
+    /// LispEnvironment::iPatternBindings. If any match fails, Matches()
+    /// returns false. Otherwise, SetPatternVariables() declares the
+    /// pattern variables in the current LispLocalFrame and
+    /// CheckPredicates() is called. The pattern variables and whatever
+    /// the predicates declared are dropped again; if the predicates
+    /// hold, the pattern variables are declared once more with the
+    /// values matched, where the body of the rule will see them.
     bool Matches(LispEnvironment& aEnvironment, LispPtr& aArguments);
 
     /// Try to match the pattern against \a aArguments.
@@ -170,26 +118,39 @@ public:
     /// but differs in the type of the arguments.
     bool Matches(LispEnvironment& aEnvironment, LispPtr* aArguments);
 
+    /// Return the structural requirement on argument \a aParameter,
+    /// or PatternKey::Any if the pattern has no such argument.
+    PatternKey Key(std::size_t aParameter) const;
+
 protected:
-    /// Construct a pattern matcher out of a Lisp expression.
-    /// The result of this function depends on the value of \a aPattern:
-    /// - If \a aPattern is a number, the corresponding MatchNumber is
-    ///   constructed and returned.
-    /// - If \a aPattern is an atom, the corresponding MatchAtom is
-    ///   constructed and returned.
+    /// Compile a Lisp expression into pattern instructions, appending
+    /// them to #iProgram.
+    /// The instructions emitted depend on the value of \a aPattern:
+    /// - If \a aPattern is a number, a PatternInstruction::Number.
+    /// - If \a aPattern is an atom, a PatternInstruction::Atom.
     /// - If \a aPattern is a list of the form <tt>( _ var )<tt>,
-    ///   where \c var is an atom, LookUp() is called on \c var. Then
-    ///   the correspoding MatchVariable is constructed and returned.
+    ///   where \c var is an atom, LookUp() is called on \c var, and
+    ///   the correspoding PatternInstruction::Variable is emitted.
     /// - If \a aPattern is a list of the form <tt>( _ var expr )<tt>,
     ///   where \c var is an atom, LookUp() is called on \c var. Then,
     ///   \a expr is appended to #iPredicates. Finally, the
-    ///   correspoding MatchVariable is constructed and returned.
-    /// - If \a aPattern is a list of another form, this function
-    ///   calls itself on any of the entries in this list. The
-    ///   resulting YacasParamMatcherBase objects are collected in a
-    ///   MatchSubList, which is returned.
-    /// - Otherwise, this function returns #nullptr.
-    const YacasParamMatcherBase* MakeParamMatcher(LispEnvironment& aEnvironment, LispObject* aPattern);
+    ///   correspoding PatternInstruction::Variable is emitted.
+    /// - If \a aPattern is a list of another form, a
+    ///   PatternInstruction::Enter is emitted, this function calls
+    ///   itself on any of the entries in this list, and a
+    ///   PatternInstruction::Leave is emitted.
+    /// \returns the nesting depth of lists in \a aPattern.
+    std::size_t Compile(LispEnvironment& aEnvironment, LispObject* aPattern);
+
+    /// Run the instructions for parameter \a aParameter on \a aExpression.
+    /// \param arguments (input/output) actual values of the pattern
+    /// variables. An empty entry is bound to the element the
+    /// PatternInstruction::Variable is run on, otherwise the element
+    /// has to equal the value in the entry.
+    bool ArgumentMatches(LispEnvironment& aEnvironment,
+                         std::size_t aParameter,
+                         LispPtr& aExpression,
+                         LispPtr* arguments);
 
     /// Look up a variable name in #iVariables
     /// \returns index in #iVariables array where \a aVariable
@@ -212,9 +173,22 @@ protected:
     /// neither IsTrue() nor IsFalse().
     bool CheckPredicates(LispEnvironment& aEnvironment);
 
+    /// Call CheckPredicates() with the pattern variables set to the
+    /// values from index \a aBindings on in
+    /// LispEnvironment::iPatternBindings, see Matches().
+    bool MatchPredicates(LispEnvironment& aEnvironment, std::size_t aBindings);
+
 protected:
-    /// List of parameter matches, one for every parameter.
-    std::vector<const YacasParamMatcherBase*> iParamMatchers;
+    /// Compiled pattern, the instructions for all parameters.
+    std::vector<PatternInstruction> iProgram;
+
+    /// Offset of the instructions for every parameter in #iProgram,
+    /// followed by the size of #iProgram.
+    std::vector<std::size_t> iParameters;
+
+    /// Cursors to continue from after a PatternInstruction::Leave.
+    /// Sized to the deepest nesting of lists in the pattern.
+    std::vector<LispPtr*> iStack;
 
     /// List of variables appearing in the pattern.
     std::vector<LispStringSmartPtr> iVariables;
@@ -13,29 +13,36 @@
   One can use RefPtr on any arbitrary object from that moment on.
  */
 
+#ifdef YACAS_REFCOUNT_STATISTICS
+/// Number of reference count increments and decrements RefPtr did on
+/// this thread. Only kept if built with YACAS_REFCOUNT_STATISTICS.
+inline thread_local unsigned long long RefCountOperations = 0;
+#define YACAS_COUNT_REFCOUNT_OPERATION() (++RefCountOperations)
+#else
+#define YACAS_COUNT_REFCOUNT_OPERATION() ((void)0)
+#endif
+
 template<class T>
 class RefPtr {
 public:
   // Default constructor (not explicit, so it auto-initializes)
   inline RefPtr() : iPtr(nullptr) {}
   // Construct from pointer to T
-  /*explicit*/ RefPtr(T* ptr) : iPtr(ptr) { if (ptr) { ptr->_use_count++; } }
+  /*explicit*/ RefPtr(T* ptr) : iPtr(ptr) { Acquire(ptr); }
   // Copy constructor
-  RefPtr(const RefPtr &refPtr) : iPtr(refPtr.ptr()) { if (iPtr) { iPtr->_use_count++; } }
+  RefPtr(const RefPtr &refPtr) : iPtr(refPtr.ptr()) { Acquire(iPtr); }
+  // Move constructor, takes over the reference of refPtr
+  RefPtr(RefPtr &&refPtr) noexcept : iPtr(refPtr.iPtr) { refPtr.iPtr = nullptr; }
   // Destructor
   ~RefPtr()
   {
-      if (iPtr && !--iPtr->_use_count)
-        delete iPtr;
+      Release(iPtr);
   }
   // Assignment from pointer
   RefPtr &operator=(T *ptr)
   {
-    if (ptr)
-      ptr->_use_count++;
-
-    if (iPtr && !--iPtr->_use_count)
-      delete iPtr;
+    Acquire(ptr);
+    Release(iPtr);
 
     iPtr = ptr;
 
@@ -43,6 +50,20 @@ public:
   }
   // Assignment from another
   RefPtr &operator=(const RefPtr &refPtr) { return this->operator=(refPtr.ptr()); }
+  // Move assignment, takes over the reference of refPtr. The old
+  // object is only released once the new one is in place, as it may
+  // own refPtr.
+  RefPtr &operator=(RefPtr &&refPtr) noexcept
+  {
+    T* ptr = refPtr.iPtr;
+    refPtr.iPtr = nullptr;
+
+    T* old = iPtr;
+    iPtr = ptr;
+    Release(old);
+
+    return *this;
+  }
 
   operator T*()    const { return  iPtr; }  // implicit conversion to pointer to T
   T &operator*()   const { return *iPtr; }  // so (*refPtr) is a reference to T
@@ -51,6 +72,23 @@ public:
   bool operator!() const { return !iPtr; }  // is null pointer
 
 private:
+  static void Acquire(T* ptr)
+  {
+    if (ptr) {
+      YACAS_COUNT_REFCOUNT_OPERATION();
+      ptr->_use_count++;
+    }
+  }
+
+  static void Release(T* ptr)
+  {
+    if (ptr) {
+      YACAS_COUNT_REFCOUNT_OPERATION();
+      if (!--ptr->_use_count)
+        delete ptr;
+    }
+  }
+
    T *iPtr;
 };
 
@@ -33,6 +33,12 @@ bool InternalEquals(const LispEnvironment& aEnvironment,
                     const LispPtr& aExpression1,
                     const LispPtr& aExpression2);
 
+/// Structural hash of \a aExpression, ignoring the rest of the list
+/// it is in. Expressions InternalEquals() takes for equal hash alike,
+/// see BigNumber::Hash() for the exception.
+std::size_t InternalHash(const LispEnvironment& aEnvironment,
+                         const LispPtr& aExpression);
+
 
 inline LispPtr& Argument(LispPtr& cur, int n);
 
@@ -11,14 +11,22 @@
 #include <cctype>
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 class LispTokenizer {
 public:
     virtual ~LispTokenizer() = default;
 
     /// NextToken returns a string representing the next token,
-    /// or an empty list.
-    virtual std::string NextToken(LispInput& aInput);
+    /// or an empty list. The string is only valid until the next
+    /// call; it is meant to be looked up in the hash table straight
+    /// away.
+    virtual std::string_view NextToken(LispInput& aInput);
+
+protected:
+    /// The token being read. Reused from token to token, so that
+    /// reading a token does not allocate.
+    std::string iToken;
 };
 
 // utility functions
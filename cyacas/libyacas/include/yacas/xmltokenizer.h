@@ -10,7 +10,7 @@ public:
   XmlTokenizer() {}
   /// NextToken returns a string representing the next token,
   /// or an empty list.
-  std::string NextToken(LispInput& aInput) override;
+  std::string_view NextToken(LispInput& aInput) override;
 };
 
 #endif
@@ -32,6 +32,7 @@ class DefaultYacasEnvironment: NonCopyable
 public:
   explicit DefaultYacasEnvironment(std::ostream&);
   LispEnvironment& getEnv() {return iEnvironment;}
+  const LispEnvironment& getEnv() const {return iEnvironment;}
 
 private:
   std::ostream& output;
@@ -92,6 +93,18 @@ public:
     /// Whether an error occured during the last evaluation.
     bool IsError() const;
 
+    /// Bytes used by the evaluations so far, and still in use.
+    /// Memory is accounted per thread, see MemoryAccount: instances
+    /// evaluating on the same thread are charged for each other's.
+    std::size_t MemoryUsage() const;
+
+    /// Most bytes in use at any time during the evaluations so far.
+    std::size_t PeakMemoryUsage() const;
+
+    /// Make an evaluation fail with LispErrNotEnoughMemory once the
+    /// memory in use grows past \p aBytes; 0, the default, for no limit.
+    void SetMemoryLimit(std::size_t aBytes);
+
 private:
 
     /// The underlying Yacas environment
@@ -19,12 +19,32 @@
 
 #include "yacas/associationclass.h"
 
+const AssociationClass::Order& AssociationClass::Ordered() const
+{
+    if (!_order) {
+        _order.reset(new Order);
+        for (Map::const_reference e : _map)
+            _order->insert(&e);
+    }
+
+    return *_order;
+}
+
+void AssociationClass::References(std::vector<LispObject*>& aObjects) const
+{
+    for (Map::const_reference e : _map) {
+        aObjects.push_back(e.first.value);
+        if (e.second)
+            aObjects.push_back(e.second);
+    }
+}
+
 LispPtr AssociationClass::Keys() const
 {
     LispPtr head(LispAtom::New(const_cast<LispEnvironment&>(_env), "List"));
     LispPtr p(head);
-    for (std::map<Key, LispPtr>::const_reference e : _map) {
-        p->Nixed() = e.first.value->Copy();
+    for (Map::const_pointer e : Ordered()) {
+        p->Nixed() = e->first.value->Copy();
         p = p->Nixed();
     }
     return LispPtr(LispSubList::New(head));
@@ -34,13 +54,13 @@ LispPtr AssociationClass::ToList() const
 {
     LispPtr head(LispAtom::New(const_cast<LispEnvironment&>(_env), "List"));
     LispPtr p(head);
-    for (std::map<Key, LispPtr>::const_reference e : _map) {
+    for (Map::const_pointer e : Ordered()) {
         LispPtr q(LispAtom::New(const_cast<LispEnvironment&>(_env), "List"));
         p->Nixed() = LispSubList::New(q);
         p = p->Nixed();
-        q->Nixed() = e.first.value->Copy();
+        q->Nixed() = e->first.value->Copy();
         q = q->Nixed();
-        q->Nixed() = e.second->Copy();
+        q->Nixed() = e->second->Copy();
     }
     return LispPtr(LispSubList::New(head));
 }
@@ -49,7 +69,7 @@ LispPtr AssociationClass::Head() const
 {
     assert(_map.size());
 
-    std::map<Key, LispPtr>::const_reference e = *_map.begin();
+    Map::const_reference e = **Ordered().begin();
     LispPtr p(LispAtom::New(const_cast<LispEnvironment&>(_env), "List"));
     LispPtr q(p);
     q->Nixed() = e.first.value->Copy();
@@ -0,0 +1,411 @@
+#include "yacas/compiledbody.h"
+#include "yacas/errors.h"
+#include "yacas/lispenvironment.h"
+#include "yacas/lispeval.h"
+#include "yacas/lispevalhash.h"
+#include "yacas/mathcommands.h"
+#include "yacas/mathuserfunc.h"
+#include "yacas/standard.h"
+
+#include <typeinfo>
+#include <vector>
+
+class CompiledBody::Node: NonCopyable {
+public:
+    explicit Node(LispPtr& aExpression) : iExpression(aExpression) {}
+    virtual ~Node() = default;
+
+    /// Evaluate as BasicEvaluator::Eval() would.
+    virtual void Eval(LispEnvironment& aEnvironment, LispPtr& aResult) = 0;
+
+    /// Evaluate as BasicEvaluator::EvalShared() would.
+    virtual void EvalShared(LispEnvironment& aEnvironment, LispPtr& aResult)
+    {
+        Eval(aEnvironment, aResult);
+    }
+
+    /// The expression compiled
+    LispPtr& iExpression;
+
+protected:
+    static void Enter(LispEnvironment& aEnvironment)
+    {
+        CompiledBody::Enter(aEnvironment);
+    }
+
+    static std::unique_ptr<Node> Compile(LispPtr& aExpression)
+    {
+        return CompiledBody::Compile(aExpression);
+    }
+};
+
+namespace {
+    typedef CompiledBody::Node Node;
+
+    // A string constant, which evaluates to itself
+    class Quoted: public Node {
+    public:
+        explicit Quoted(LispPtr& aExpression) : Node(aExpression) {}
+
+        void Eval(LispEnvironment& aEnvironment, LispPtr& aResult) override
+        {
+            Enter(aEnvironment);
+            aResult = iExpression->Copy();
+            aEnvironment.iEvalDepth--;
+        }
+
+        void EvalShared(LispEnvironment& aEnvironment,
+                        LispPtr& aResult) override
+        {
+            if (!aEnvironment.stop_evaluation && !iExpression->Nixed()) {
+                aResult = iExpression;
+                return;
+            }
+
+            Eval(aEnvironment, aResult);
+        }
+    };
+
+    // Any other atom: the value of the variable, or the atom itself
+    class Variable: public Node {
+    public:
+        explicit Variable(LispPtr& aExpression) :
+            Node(aExpression), iName(aExpression->String())
+        {
+        }
+
+        void Eval(LispEnvironment& aEnvironment, LispPtr& aResult) override
+        {
+            Enter(aEnvironment);
+
+            LispPtr val;
+            aEnvironment.GetVariable(iName, val);
+            if (!!val)
+                aResult = val->Copy();
+            else
+                aResult = iExpression->Copy();
+
+            aEnvironment.iEvalDepth--;
+        }
+
+        void EvalShared(LispEnvironment& aEnvironment,
+                        LispPtr& aResult) override
+        {
+            if (!aEnvironment.stop_evaluation) {
+                aEnvironment.GetVariable(iName, aResult);
+
+                if (!aResult)
+                    aResult = iExpression;
+
+                if (!aResult->Nixed())
+                    return;
+            }
+
+            Eval(aEnvironment, aResult);
+        }
+
+    private:
+        const LispString* iName;
+    };
+
+    // Anything the evaluator is to see as it is
+    class Generic: public Node {
+    public:
+        explicit Generic(LispPtr& aExpression) : Node(aExpression) {}
+
+        void Eval(LispEnvironment& aEnvironment, LispPtr& aResult) override
+        {
+            aEnvironment.iEvaluator->Eval(aEnvironment, aResult, iExpression);
+        }
+    };
+
+    // A list with an atom for its head
+    class Call: public Node {
+    public:
+        explicit Call(LispPtr& aExpression) :
+            Node(aExpression),
+            iSubList(aExpression->SubList()),
+            iGeneration(0),
+            iKind(Other),
+            iCommand(nullptr),
+            iFunction(nullptr),
+            iVariable(nullptr)
+        {
+            for (LispPtr* arg = &(*iSubList)->Nixed(); !!*arg;
+                 arg = &(*arg)->Nixed())
+                iArguments.push_back(Compile(*arg));
+        }
+
+        void Eval(LispEnvironment& aEnvironment, LispPtr& aResult) override
+        {
+            if (iGeneration != aEnvironment.iRuleBaseGeneration)
+                Resolve(aEnvironment);
+
+            switch (iKind) {
+            case Command:
+                return EvalCommand(aEnvironment, aResult);
+            case Function:
+                if (!iFunction->Traced())
+                    return EvalFunction(aEnvironment, aResult);
+                break;
+            case If:
+                return EvalIf(aEnvironment, aResult);
+            case While:
+                return EvalWhile(aEnvironment, aResult);
+            case Prog:
+                return EvalProg(aEnvironment, aResult);
+            case Set:
+                return EvalSet(aEnvironment, aResult);
+            case Other:
+                break;
+            }
+
+            aEnvironment.iEvaluator->Eval(aEnvironment, aResult, iExpression);
+        }
+
+    private:
+        enum Kind { Command, Function, If, While, Prog, Set, Other };
+
+        // Find out what the call is to, as ResolveCall() does for the
+        // evaluator. Whatever is not evaluated here exactly as the
+        // function itself would, erroneous calls included, is left to
+        // the evaluator.
+        void Resolve(LispEnvironment& aEnvironment)
+        {
+            const EvalFuncBase* func =
+                ResolveCall(aEnvironment, iExpression, iSubList);
+
+            iGeneration = aEnvironment.iRuleBaseGeneration;
+            iKind = Other;
+            iCommand = nullptr;
+            iFunction = nullptr;
+
+            const std::size_t nr = iArguments.size();
+
+            if (const YacasEvaluator* command =
+                    dynamic_cast<const YacasEvaluator*>(func)) {
+                const YacasEvalCaller caller = command->Caller();
+
+                if (!(command->Flags() & YacasEvaluator::Macro)) {
+                    if (!(command->Flags() & YacasEvaluator::Variable) &&
+                        static_cast<std::size_t>(command->NrArgs()) == nr) {
+                        iKind = Command;
+                        iCommand = command;
+                    }
+                } else if (caller == LispIf) {
+                    if (nr == 2 || nr == 3)
+                        iKind = If;
+                } else if (caller == LispWhile) {
+                    if (nr == 2)
+                        iKind = While;
+                } else if (caller == LispProgBody) {
+                    iKind = Prog;
+                } else if (caller == LispSetVar) {
+                    iVariable = nr == 2 ? iArguments[0]->iExpression->String()
+                                        : nullptr;
+                    if (iVariable && !IsNumber(*iVariable, true))
+                        iKind = Set;
+                }
+            } else if (func && typeid(*func) == typeid(BranchingUserFunction)) {
+                const BranchingUserFunction* function =
+                    static_cast<const BranchingUserFunction*>(func);
+                if (static_cast<std::size_t>(function->Arity()) == nr) {
+                    iKind = Function;
+                    iFunction = function;
+                }
+            }
+        }
+
+        void EvalCommand(LispEnvironment& aEnvironment, LispPtr& aResult)
+        {
+            Enter(aEnvironment);
+
+            const int stacktop = aEnvironment.iStack.size();
+
+            // The full expression is there for error reporting, as
+            // YacasEvaluator::Evaluate() leaves it.
+            aEnvironment.iStack.push_back(*iSubList);
+
+            const bool shared = iCommand->Flags() & YacasEvaluator::Shared;
+
+            LispPtr arg;
+            for (const std::unique_ptr<Node>& node : iArguments) {
+                if (shared)
+                    node->EvalShared(aEnvironment, arg);
+                else
+                    node->Eval(aEnvironment, arg);
+                aEnvironment.iStack.push_back(std::move(arg));
+            }
+
+            iCommand->Caller()(aEnvironment, stacktop);
+            aResult = std::move(aEnvironment.iStack[stacktop]);
+            aEnvironment.iStack.resize(stacktop);
+
+            aEnvironment.iEvalDepth--;
+        }
+
+        void EvalFunction(LispEnvironment& aEnvironment, LispPtr& aResult)
+        {
+            Enter(aEnvironment);
+
+            // Keep the function's answer to Held() from changing midway
+            const BranchingUserFunction* function = iFunction;
+            const std::size_t arity = iArguments.size();
+
+            ArgumentStack::Frame arguments(aEnvironment.iArgumentStack, arity);
+            for (std::size_t i = 0; i < arity; ++i) {
+                if (function->Held(i))
+                    arguments[i] = iArguments[i]->iExpression->Copy();
+                else
+                    iArguments[i]->Eval(aEnvironment, arguments[i]);
+            }
+
+            function->Apply(aResult, aEnvironment, *iSubList, arguments);
+
+            aEnvironment.iEvalDepth--;
+        }
+
+        void EvalIf(LispEnvironment& aEnvironment, LispPtr& aResult)
+        {
+            Enter(aEnvironment);
+
+            LispPtr predicate;
+            iArguments[0]->Eval(aEnvironment, predicate);
+
+            if (IsTrue(aEnvironment, predicate)) {
+                iArguments[1]->Eval(aEnvironment, aResult);
+            } else {
+                CheckPredicate(aEnvironment, predicate);
+                if (iArguments.size() == 3)
+                    iArguments[2]->Eval(aEnvironment, aResult);
+                else
+                    InternalFalse(aEnvironment, aResult);
+            }
+
+            aEnvironment.iEvalDepth--;
+        }
+
+        void EvalWhile(LispEnvironment& aEnvironment, LispPtr& aResult)
+        {
+            Enter(aEnvironment);
+
+            LispPtr predicate;
+            iArguments[0]->Eval(aEnvironment, predicate);
+
+            while (IsTrue(aEnvironment, predicate)) {
+                LispPtr evaluated;
+                iArguments[1]->Eval(aEnvironment, evaluated);
+                iArguments[0]->Eval(aEnvironment, predicate);
+            }
+            CheckPredicate(aEnvironment, predicate);
+            InternalTrue(aEnvironment, aResult);
+
+            aEnvironment.iEvalDepth--;
+        }
+
+        void EvalProg(LispEnvironment& aEnvironment, LispPtr& aResult)
+        {
+            Enter(aEnvironment);
+
+            {
+                // Allow accessing previous locals.
+                LispLocalFrame frame(aEnvironment, false);
+
+                InternalTrue(aEnvironment, aResult);
+                for (const std::unique_ptr<Node>& node : iArguments)
+                    node->Eval(aEnvironment, aResult);
+            }
+
+            aEnvironment.iEvalDepth--;
+        }
+
+        void EvalSet(LispEnvironment& aEnvironment, LispPtr& aResult)
+        {
+            Enter(aEnvironment);
+
+            LispPtr result;
+            iArguments[1]->Eval(aEnvironment, result);
+            aEnvironment.SetVariable(iVariable, result, false);
+            InternalTrue(aEnvironment, aResult);
+
+            aEnvironment.iEvalDepth--;
+        }
+
+        // Fail on a predicate that is not False, as If and While do
+        void CheckPredicate(LispEnvironment& aEnvironment,
+                            const LispPtr& aPredicate)
+        {
+            if (IsFalse(aEnvironment, aPredicate))
+                return;
+
+            aEnvironment.iStack.push_back(*iSubList);
+            CheckArg(false, 1, aEnvironment, aEnvironment.iStack.size() - 1);
+        }
+
+        LispPtr* iSubList;
+        std::vector<std::unique_ptr<Node>> iArguments;
+
+        /// Value of LispEnvironment::iRuleBaseGeneration when resolved
+        std::size_t iGeneration;
+        Kind iKind;
+        const YacasEvaluator* iCommand;
+        const BranchingUserFunction* iFunction;
+        /// Variable set by Set
+        const LispString* iVariable;
+    };
+}
+
+CompiledBody::CompiledBody(LispPtr& aExpression) :
+    iExpression(aExpression),
+    iRoot(Compile(iExpression))
+{
+}
+
+CompiledBody::~CompiledBody() = default;
+
+void CompiledBody::Eval(LispEnvironment& aEnvironment,
+                        LispPtr& aResult,
+                        LispPtr& aExpression,
+                        std::shared_ptr<CompiledBody>& aCompiled)
+{
+    if (typeid(*aEnvironment.iEvaluator) != typeid(BasicEvaluator)) {
+        aEnvironment.iEvaluator->Eval(aEnvironment, aResult, aExpression);
+        return;
+    }
+
+    if (!aCompiled)
+        aCompiled = std::make_shared<CompiledBody>(aExpression);
+
+    // Keep the nodes alive, evaluating may drop the rule they are for
+    const std::shared_ptr<CompiledBody> compiled = aCompiled;
+    compiled->iRoot->Eval(aEnvironment, aResult);
+}
+
+void CompiledBody::Enter(LispEnvironment& aEnvironment)
+{
+    BasicEvaluator* evaluator =
+        static_cast<BasicEvaluator*>(aEnvironment.iEvaluator);
+
+    evaluator->CheckInterrupt(aEnvironment);
+
+    aEnvironment.iEvalDepth++;
+    if (aEnvironment.iEvalDepth >= aEnvironment.iMaxEvalDepth) {
+        evaluator->ShowStack(aEnvironment, aEnvironment.CurrentOutput());
+        throw LispErrMaxRecurseDepthReached();
+    }
+}
+
+std::unique_ptr<CompiledBody::Node> CompiledBody::Compile(LispPtr& aExpression)
+{
+    if (const LispString* str = aExpression->String()) {
+        if (str->front() == '\"')
+            return std::unique_ptr<Node>(new Quoted(aExpression));
+        return std::unique_ptr<Node>(new Variable(aExpression));
+    }
+
+    LispPtr* subList = aExpression->SubList();
+    if (subList && !!*subList && (*subList)->String())
+        return std::unique_ptr<Node>(new Call(aExpression));
+
+    return std::unique_ptr<Node>(new Generic(aExpression));
+}
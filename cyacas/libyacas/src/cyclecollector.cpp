@@ -0,0 +1,199 @@
+#include "yacas/cyclecollector.h"
+#include "yacas/genericobject.h"
+#include "yacas/lispatom.h"
+
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // An object or a container, exactly one of them non-null
+    struct Ref {
+        LispObject* object;
+        GenericClass* container;
+
+        const void* Key() const
+        {
+            return object ? static_cast<const void*>(object) : container;
+        }
+    };
+
+    struct Node {
+        Ref ref;
+        /// References from outside the part walked
+        long count;
+        bool live;
+    };
+
+    void Children(const Ref& r, std::vector<Ref>& aChildren)
+    {
+        aChildren.clear();
+
+        if (LispObject* o = r.object) {
+            if (o->Nixed())
+                aChildren.push_back({o->Nixed(), nullptr});
+            if (LispPtr* sub = o->SubList())
+                if (*sub)
+                    aChildren.push_back({*sub, nullptr});
+            if (GenericClass* g = o->Generic())
+                aChildren.push_back({nullptr, g});
+        } else {
+            std::vector<LispObject*> objects;
+            r.container->References(objects);
+            for (LispObject* p : objects)
+                aChildren.push_back({p, nullptr});
+        }
+    }
+
+    std::size_t Bytes(const Ref& r)
+    {
+        if (r.container)
+            return r.container->Footprint();
+        if (r.object->Generic())
+            return sizeof(LispGenericClass);
+        if (r.object->SubList())
+            return sizeof(LispSubList);
+        if (r.object->IsNumber())
+            return sizeof(LispNumber);
+        return sizeof(LispAtom);
+    }
+
+    std::size_t Find(std::vector<std::size_t>& parent, std::size_t i)
+    {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    }
+}
+
+GenericClass::~GenericClass()
+{
+    if (iCollector)
+        iCollector->Untrack(this);
+}
+
+CycleCollector::CycleCollector() : iThreshold(0), _since(0) {}
+
+CycleCollector::~CycleCollector()
+{
+    for (GenericClass* g : _tracked)
+        g->iCollector = nullptr;
+}
+
+void CycleCollector::Track(GenericClass* aClass)
+{
+    aClass->iCollector = this;
+    _tracked.insert(aClass);
+    _since += 1;
+}
+
+void CycleCollector::Untrack(GenericClass* aClass)
+{
+    _tracked.erase(aClass);
+}
+
+CycleCollector::Statistics CycleCollector::Collect()
+{
+    _since = 0;
+
+    std::vector<Node> nodes;
+    std::unordered_map<const void*, std::size_t> index;
+    std::vector<std::size_t> work;
+    std::vector<Ref> children;
+
+    auto visit = [&](const Ref& r) {
+        auto i = index.emplace(r.Key(), nodes.size());
+        if (i.second) {
+            const long count =
+                r.object ? r.object->use_count() : r.container->iReferenceCount;
+            nodes.push_back({r, count, false});
+            work.push_back(i.first->second);
+        }
+        return i.first->second;
+    };
+
+    // Walk everything the containers reach, taking the references
+    // met on the way off the counts
+    for (GenericClass* g : _tracked)
+        visit({nullptr, g});
+
+    while (!work.empty()) {
+        const std::size_t n = work.back();
+        work.pop_back();
+
+        Children(nodes[n].ref, children);
+        for (const Ref& c : children)
+            nodes[visit(c)].count -= 1;
+    }
+
+    // What is left with references from outside is in use, and so is
+    // everything it reaches
+    for (std::size_t n = 0; n < nodes.size(); ++n)
+        if (nodes[n].count > 0 && !nodes[n].live) {
+            nodes[n].live = true;
+            work.push_back(n);
+        }
+
+    while (!work.empty()) {
+        const std::size_t n = work.back();
+        work.pop_back();
+
+        Children(nodes[n].ref, children);
+        for (const Ref& c : children) {
+            Node& child = nodes[index[c.Key()]];
+            if (!child.live) {
+                child.live = true;
+                work.push_back(index[c.Key()]);
+            }
+        }
+    }
+
+    // The rest is garbage, tell the groups of it apart
+    Statistics stats;
+
+    std::vector<std::size_t> parent(nodes.size());
+    std::iota(parent.begin(), parent.end(), 0);
+
+    std::vector<GenericClass*> garbage;
+
+    for (std::size_t n = 0; n < nodes.size(); ++n) {
+        const Node& node = nodes[n];
+
+        if (node.live)
+            continue;
+
+        if (node.ref.container)
+            garbage.push_back(node.ref.container);
+        else
+            stats.objects += 1;
+
+        stats.bytes += Bytes(node.ref);
+
+        Children(node.ref, children);
+        for (const Ref& c : children) {
+            const std::size_t m = index[c.Key()];
+            if (!nodes[m].live)
+                parent[Find(parent, n)] = Find(parent, m);
+        }
+    }
+
+    for (std::size_t n = 0; n < nodes.size(); ++n)
+        if (!nodes[n].live && Find(parent, n) == n)
+            stats.cycles += 1;
+
+    stats.containers = garbage.size();
+
+    // Emptying the containers breaks the cycles. They are held on to
+    // until all of them are empty, as they may hold each other.
+    for (GenericClass* g : garbage)
+        g->iReferenceCount += 1;
+
+    for (GenericClass* g : garbage)
+        g->Clear();
+
+    for (GenericClass* g : garbage)
+        if (--g->iReferenceCount == 0)
+            delete g;
+
+    return stats;
+}
@@ -0,0 +1,139 @@
+#include "yacas/hashcons.h"
+#include "yacas/lispatom.h"
+#include "yacas/lispenvironment.h"
+#include "yacas/standard.h"
+
+#include <functional>
+#include <vector>
+
+namespace {
+    enum Kind { ATOM, NUMBER, LIST };
+
+    // The collection runs when the table has doubled since the last one
+    const std::size_t MIN_COLLECT = 4096;
+}
+
+bool HashConsTable::Key::operator==(const Key& other) const
+{
+    return kind == other.kind && payload == other.payload && next == other.next;
+}
+
+std::size_t HashConsTable::KeyHash::operator()(const Key& key) const
+{
+    const std::size_t h = std::hash<const void*>()(key.payload);
+    return (h * 31 + std::hash<const void*>()(key.next)) * 31 + key.kind;
+}
+
+HashConsTable::HashConsTable():
+    _collected(0)
+{
+}
+
+LispPtr HashConsTable::Cons(LispEnvironment& aEnvironment,
+                            const LispPtr& aExpression)
+{
+    if (_elements.size() >= 2 * _collected + MIN_COLLECT) {
+        Collect();
+        _collected = _elements.size();
+    }
+
+    // The expression is an element without a rest
+    Entry none{nullptr, nullptr};
+    Entry result;
+    if (!ConsElement(aEnvironment, aExpression, none, result))
+        return aExpression;
+
+    // The element in the table may have been shared already; hand out a
+    // copy, which shares its sublist, so that the caller can link it.
+    return LispPtr(result.element->Copy());
+}
+
+bool HashConsTable::ConsList(LispEnvironment& aEnvironment,
+                             LispObject* aFirst,
+                             LispPtr& aResult)
+{
+    std::vector<LispObject*> elements;
+    for (LispObject* p = aFirst; p; p = p->Nixed())
+        elements.push_back(p);
+
+    Entry next{nullptr, nullptr};
+
+    for (auto i = elements.rbegin(); i != elements.rend(); ++i) {
+        Entry e;
+        if (!ConsElement(aEnvironment, *i, next, e))
+            return false;
+        next = std::move(e);
+    }
+
+    aResult = std::move(next.element);
+
+    return true;
+}
+
+bool HashConsTable::ConsElement(LispEnvironment& aEnvironment,
+                                LispObject* aElement,
+                                const Entry& aNext,
+                                Entry& aResult)
+{
+    Key key{ATOM, nullptr, aNext.element};
+    LispPtr list;
+    LispStringSmartPtr number;
+
+    if (aElement->IsNumber()) {
+        number = aEnvironment.HashTable().LookUp(*aElement->String());
+        key.kind = NUMBER;
+        key.payload = number;
+    } else if (const LispString* s = aElement->String()) {
+        key.payload = s;
+    } else if (LispPtr* l = aElement->SubList()) {
+        if (!ConsList(aEnvironment, *l, list))
+            return false;
+        key.kind = LIST;
+        key.payload = list.ptr();
+    } else {
+        return false;
+    }
+
+    auto i = _elements.find(key);
+    if (i != _elements.end()) {
+        aResult = i->second;
+        return true;
+    }
+
+    LispPtr element;
+    if (key.kind == LIST) {
+        LispSubList* sub = LispSubList::New(list);
+        element = sub;
+        // the sublists in the list are hash-consed, so they have their
+        // hash already
+        sub->iHash = InternalHash(aEnvironment, element);
+    } else {
+        element = aElement->Copy();
+    }
+    element->Nixed() = aNext.element;
+    element->iConsed = true;
+
+    aResult.element = element;
+    aResult.number = number;
+
+    _elements.emplace(key, aResult);
+
+    return true;
+}
+
+void HashConsTable::Collect()
+{
+    // Dropping an element may leave its rest or its sublist unused, so
+    // go on until nothing changes.
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto i = _elements.begin(); i != _elements.end();) {
+            if (i->second.element->use_count() == 1) {
+                i = _elements.erase(i);
+                changed = true;
+            } else {
+                ++i;
+            }
+        }
+    }
+}
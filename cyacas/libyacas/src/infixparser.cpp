@@ -153,7 +153,7 @@ void ParsedObject::ReadExpression(int depth)
                     len -= 1;
                     const LispString* lookUp =
                         iParser.iEnvironment.HashTable().LookUp(
-                            iLookAhead->substr(0, len));
+                            std::string_view(*iLookAhead).substr(0, len));
 
                     opi = iParser.iInfixOperators.find(lookUp);
 
@@ -161,7 +161,7 @@ void ParsedObject::ReadExpression(int depth)
 
                         const LispString* lookUpRight =
                             iParser.iEnvironment.HashTable().LookUp(
-                                iLookAhead->substr(len, origlen - len));
+                                std::string_view(*iLookAhead).substr(len, origlen - len));
 
                         if (iParser.iPrefixOperators.find(lookUpRight) !=
                             iParser.iPrefixOperators.end()) {
@@ -6,12 +6,15 @@
 
 #include <algorithm>
 #include <cassert>
+#include <charconv>
+#include <limits>
+#include <string>
 
 /// construct an atom from a string representation.
 LispObject* LispAtom::New(LispEnvironment& aEnvironment,
                           const std::string& aString)
 {
-    if (IsNumber(aString, true)) // check if aString is a number (int or float)
+    if (::IsNumber(aString, true)) // check if aString is a number (int or float)
         return new LispNumber(new LispString(aString),
                               aEnvironment.Precision());
 
@@ -47,30 +50,8 @@ LispSubList* LispSubList::New(LispObject* aSubList)
 // a tail-recursive way...
 LispSubList::~LispSubList()
 {
-    if (!!iSubList) {
-        LispPtr next;
-        LispIterator iter(iSubList);
-        bool busy = (iter.getObj()->use_count() == 1);
-        while (busy) // while there are things to delete...
-        {
-            // TODO: woof -- fix this ugliness!
-            LispPtr nextToDelete;
-            // Make sure "next" holds the tail of the list
-            nextToDelete = (iter.getObj()->Nixed());
-            // Separate out the current element...
-            if (iter.getObj()->use_count() ==
-                1) { // Destructive operation only if necessary...
-                iter.getObj()->Nixed() = (nullptr);
-                // And delete it.
-                (*iter) = (nullptr);
-            } else
-                busy = false;
-            next = (nextToDelete);
-            iter = next;
-            if (!iter.getObj())
-                busy = false;
-        }
-    }
+    if (!!iSubList)
+        LispReclaimer::Release(iSubList);
 }
 
 //------------------------------------------------------------------------------
@@ -106,10 +87,32 @@ GenericClass* LispGenericClass::Generic()
 //------------------------------------------------------------------------------
 // LispNumber methods - proceed at your own risk
 
+LispNumber::LispNumber(LispString* aString, int aBasePrecision) :
+    iNumber(nullptr),
+    iString(aString),
+    iValue(0),
+    iSmall(false)
+{
+    // integers that fit a machine word are kept as they are
+    const char* first = aString->data();
+    const char* last = first + aString->size();
+
+    if (first != last && *first == '+')
+        ++first;
+
+    const std::from_chars_result r = std::from_chars(first, last, iValue);
+    iSmall = r.ec == std::errc() && r.ptr == last;
+
+    if (!iSmall)
+        Number(aBasePrecision);
+}
+
 /// return a string representation in decimal
 LispString* LispNumber::String()
 {
-    if (!iString) {
+    if (!iString && iSmall) {
+        iString = new LispString(std::to_string(iValue));
+    } else if (!iString) {
         assert(
             iNumber
                 .ptr()); // either the string is null or the number but not both
@@ -131,7 +134,14 @@ LispString* LispNumber::String()
 // BigNumber object is already present
 BigNumber* LispNumber::Number(int aBasePrecision)
 {
-    if (!iNumber) { // create and store a BigNumber out of string
+    if (!iNumber && iSmall) {
+        // mp::ZZ takes an int, not the most negative one
+        if (iValue > std::numeric_limits<int>::min() &&
+            iValue <= std::numeric_limits<int>::max())
+            iNumber = new BigNumber(mp::ZZ(static_cast<int>(iValue)));
+        else
+            iNumber = new BigNumber(mp::ZZ(std::to_string(iValue)));
+    } else if (!iNumber) { // create and store a BigNumber out of string
         assert(iString.ptr());
         // aBasePrecision is in digits, not in bits, ok
         iNumber = new BigNumber(*iString, aBasePrecision, BASE10);
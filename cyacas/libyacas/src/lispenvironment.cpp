@@ -28,6 +28,9 @@ LispEnvironment::LispEnvironment(YacasCoreCommands& aCoreCommands,
     // iCleanup(),
     iEvalDepth(0),
     iMaxEvalDepth(1000),
+    iRuleBaseGeneration(1),
+    iListGeneration(1),
+    iPatternBindings(),
     stop_evaluation(false),
     iEvaluator(new BasicEvaluator),
     iInputStatus(),
@@ -48,6 +51,9 @@ LispEnvironment::LispEnvironment(YacasCoreCommands& aCoreCommands,
     iProg(),
     iLastUniqueId(1),
     iDebugger(nullptr),
+    _local_vars(),
+    _local_frames(),
+    _fence(0),
     iInitialOutput(&aOutput),
     iCoreCommands(aCoreCommands),
     iUserFunctions(aUserFunctions),
@@ -117,22 +123,13 @@ LispPtr* LispEnvironment::FindLocal(const LispString* aVariable)
 {
     assert(!_local_frames.empty());
 
-    std::size_t last = _local_vars.size();
+    // Only the innermost variable with this name can be visible, and
+    // it is unless a fenced frame hides it.
+    const std::size_t i = aVariable->iSymbol.iLocal;
 
-    for (std::vector<LocalVariableFrame>::const_reverse_iterator f =
-             _local_frames.rbegin();
-         f != _local_frames.rend();
-         ++f) {
-        const std::size_t first = f->first;
-        for (std::size_t i = last; i > first; --i)
-            if (_local_vars[i - 1].var == aVariable)
-                return &_local_vars[i - 1].val;
+    if (i > _fence)
+        return _local_vars[i - 1].Value();
 
-        if (f->fenced)
-            break;
-
-        last = first;
-    }
     return nullptr;
 }
 
@@ -149,16 +146,17 @@ void LispEnvironment::SetVariable(const LispString* aVariable,
     if (Protected(aVariable))
         throw LispErrProtectedSymbol(*aVariable);
 
-    auto i = iGlobals.find(aVariable);
-    if (i != iGlobals.end())
-        i->second = LispGlobalVariable(aValue);
+    LispGlobalVariable*& global = aVariable->iSymbol.iGlobal;
+    if (global)
+        *global = LispGlobalVariable(aValue);
     else
-        i = iGlobals
-                .insert(std::make_pair(aVariable, LispGlobalVariable(aValue)))
-                .first;
+        global = &iGlobals
+                      .insert(std::make_pair(aVariable,
+                                             LispGlobalVariable(aValue)))
+                      .first->second;
 
     if (aGlobalLazyVariable)
-        i->second.SetEvalBeforeReturn(true);
+        global->SetEvalBeforeReturn(true);
 }
 
 void LispEnvironment::GetVariable(const LispString* aVariable, LispPtr& aResult)
@@ -170,19 +168,16 @@ void LispEnvironment::GetVariable(const LispString* aVariable, LispPtr& aResult)
         return;
     }
 
-    auto i = iGlobals.find(aVariable);
-
-    if (i != iGlobals.end()) {
-        LispGlobalVariable* l = &i->second;
+    if (LispGlobalVariable* l = aVariable->iSymbol.iGlobal) {
         if (l->iEvalBeforeReturn) {
             iEvaluator->Eval(*this, aResult, l->iValue);
             // re-lookup the global variable, as this pointer might now be
             // invalid due to the evaluation actually changing the global
             // itself.
-            l = &iGlobals.find(aVariable)->second;
-
-            l->iValue = aResult;
-            l->iEvalBeforeReturn = false;
+            if ((l = aVariable->iSymbol.iGlobal)) {
+                l->iValue = aResult;
+                l->iEvalBeforeReturn = false;
+            }
         } else {
             aResult = l->iValue;
         }
@@ -198,20 +193,24 @@ void LispEnvironment::UnsetVariable(const LispString* var)
         if (Protected(var))
             throw LispErrProtectedSymbol(*var);
         iGlobals.erase(var);
+        var->iSymbol.iGlobal = nullptr;
     }
 }
 
 void LispEnvironment::PushLocalFrame(bool fenced)
 {
-    _local_frames.emplace_back(_local_vars.size(), fenced);
+    _local_frames.emplace_back(_local_vars.size(), fenced, _fence);
+
+    if (fenced)
+        _fence = _local_vars.size();
 }
 
 void LispEnvironment::PopLocalFrame()
 {
     assert(!_local_frames.empty());
 
-    _local_vars.erase(_local_vars.begin() + _local_frames.back().first,
-                      _local_vars.end());
+    DropLocals(_local_frames.back().first);
+    _fence = _local_frames.back().fence;
     _local_frames.pop_back();
 }
 
@@ -220,6 +219,37 @@ void LispEnvironment::NewLocal(const LispString* var, LispObject* val)
     assert(!_local_frames.empty());
 
     _local_vars.emplace_back(var, val);
+    var->iSymbol.iLocal = _local_vars.size();
+}
+
+void LispEnvironment::BindLocal(const LispString* var, LispPtr* slot)
+{
+    assert(!_local_frames.empty());
+
+    _local_vars.emplace_back(var, slot);
+    var->iSymbol.iLocal = _local_vars.size();
+}
+
+void LispEnvironment::DropLocals(std::size_t first)
+{
+    while (_local_vars.size() > first) {
+        const LispLocalVariable& v = _local_vars.back();
+        v.var->iSymbol.iLocal = v.shadowed;
+        _local_vars.pop_back();
+    }
+}
+
+std::size_t LispEnvironment::LocalsMark() const
+{
+    return _local_vars.size();
+}
+
+void LispEnvironment::PopLocals(std::size_t aMark)
+{
+    assert(!_local_frames.empty());
+    assert(aMark >= _local_frames.back().first);
+
+    DropLocals(aMark);
 }
 
 void LispEnvironment::CurrentLocals(LispPtr& aResult)
@@ -313,9 +343,9 @@ void LispEnvironment::SetCurrentOutput(std::ostream& aOutput)
 
 LispUserFunction* LispEnvironment::UserFunction(LispPtr& aArguments)
 {
-    auto i = iUserFunctions.find(aArguments->String());
-    if (i != iUserFunctions.end()) {
-        LispMultiUserFunction* multiUserFunc = &i->second;
+    const LispString* name = aArguments->String();
+    if (name && name->iSymbol.iUserFunction) {
+        LispMultiUserFunction* multiUserFunc = name->iSymbol.iUserFunction;
         int arity = InternalListLength(aArguments) - 1;
         return multiUserFunc->UserFunc(arity);
     }
@@ -325,9 +355,8 @@ LispUserFunction* LispEnvironment::UserFunction(LispPtr& aArguments)
 LispUserFunction* LispEnvironment::UserFunction(const LispString* aName,
                                                 int aArity)
 {
-    auto i = iUserFunctions.find(aName);
-    if (i != iUserFunctions.end())
-        return i->second.UserFunc(aArity);
+    if (LispMultiUserFunction* multiUserFunc = aName->iSymbol.iUserFunction)
+        return multiUserFunc->UserFunc(aArity);
 
     return nullptr;
 }
@@ -337,13 +366,11 @@ void LispEnvironment::UnFenceRule(const LispString* aOperator, int aArity)
     if (Protected(aOperator))
         throw LispErrProtectedSymbol(*aOperator);
 
-    auto i = iUserFunctions.find(aOperator);
+    LispMultiUserFunction* multiUserFunc = aOperator->iSymbol.iUserFunction;
 
-    if (i == iUserFunctions.end())
+    if (!multiUserFunc)
         throw LispErrInvalidArg();
 
-    LispMultiUserFunction* multiUserFunc = &i->second;
-
     LispUserFunction* userFunc = multiUserFunc->UserFunc(aArity);
 
     if (!userFunc)
@@ -357,10 +384,10 @@ void LispEnvironment::Retract(const LispString* aOperator, int aArity)
     if (Protected(aOperator))
         throw LispErrProtectedSymbol(*aOperator);
 
-    auto i = iUserFunctions.find(aOperator);
+    if (LispMultiUserFunction* multiUserFunc = aOperator->iSymbol.iUserFunction)
+        multiUserFunc->DeleteBase(aArity);
 
-    if (i != iUserFunctions.end())
-        i->second.DeleteBase(aArity);
+    iRuleBaseGeneration++;
 }
 
 void LispEnvironment::DeclareRuleBase(const LispString* aOperator,
@@ -385,6 +412,8 @@ void LispEnvironment::DeclareRuleBase(const LispString* aOperator,
                 : new BranchingUserFunction(aParameters);
 
     multiUserFunc->DefineRuleBase(newFunc);
+
+    iRuleBaseGeneration++;
 }
 
 void LispEnvironment::DeclareMacroRuleBase(const LispString* aOperator,
@@ -401,47 +430,50 @@ void LispEnvironment::DeclareMacroRuleBase(const LispString* aOperator,
                                      : new MacroUserFunction(aParameters);
 
     multiUserFunc->DefineRuleBase(newFunc);
+
+    iRuleBaseGeneration++;
 }
 
 LispMultiUserFunction*
 LispEnvironment::MultiUserFunction(const LispString* aOperator)
 {
-    auto i = iUserFunctions.find(aOperator);
+    LispMultiUserFunction*& multiUserFunc = aOperator->iSymbol.iUserFunction;
 
-    if (i != iUserFunctions.end())
-        return &i->second;
+    if (!multiUserFunc) {
+        LispMultiUserFunction newMulti;
+        multiUserFunc = &iUserFunctions.insert(std::make_pair(aOperator, newMulti))
+                             .first->second;
+    }
 
-    LispMultiUserFunction newMulti;
-    return &iUserFunctions.insert(std::make_pair(aOperator, newMulti))
-                .first->second;
+    return multiUserFunc;
 }
 
 void LispEnvironment::HoldArgument(const LispString* aOperator,
                                    const LispString* aVariable)
 {
-    auto i = iUserFunctions.find(aOperator);
+    LispMultiUserFunction* multiUserFunc = aOperator->iSymbol.iUserFunction;
 
-    if (i == iUserFunctions.end())
+    if (!multiUserFunc)
         throw LispErrInvalidArg();
 
-    LispMultiUserFunction* multiUserFunc = &i->second;
-
     multiUserFunc->HoldArgument(aVariable);
 }
 
 void LispEnvironment::Protect(const LispString* symbol)
 {
     protected_symbols.insert(symbol);
+    symbol->iSymbol.iProtected = true;
 }
 
 void LispEnvironment::UnProtect(const LispString* symbol)
 {
     protected_symbols.erase(symbol);
+    symbol->iSymbol.iProtected = false;
 }
 
 bool LispEnvironment::Protected(const LispString* symbol) const
 {
-    return protected_symbols.find(symbol) != protected_symbols.end();
+    return symbol->iSymbol.iProtected;
 }
 
 void LispEnvironment::DefineRule(const LispString* aOperator,
@@ -454,13 +486,11 @@ void LispEnvironment::DefineRule(const LispString* aOperator,
         throw LispErrProtectedSymbol(*aOperator);
 
     // Find existing multiuser func.
-    auto i = iUserFunctions.find(aOperator);
+    LispMultiUserFunction* multiUserFunc = aOperator->iSymbol.iUserFunction;
 
-    if (i == iUserFunctions.end())
+    if (!multiUserFunc)
         throw LispErrCreatingRule();
 
-    LispMultiUserFunction* multiUserFunc = &i->second;
-
     // Get the specific user function with the right arity
     LispUserFunction* userFunc = multiUserFunc->UserFunc(aArity);
 
@@ -474,6 +504,8 @@ void LispEnvironment::DefineRule(const LispString* aOperator,
         userFunc->DeclareRule(aPrecedence, aBody);
     } else
         userFunc->DeclareRule(aPrecedence, aPredicate, aBody);
+
+    iRuleBaseGeneration++;
 }
 
 void LispEnvironment::DefineRulePattern(const LispString* aOperator,
@@ -486,13 +518,11 @@ void LispEnvironment::DefineRulePattern(const LispString* aOperator,
     //        throw LispErrProtectedSymbol(*aOperator);
 
     // Find existing multiuser func.
-    auto i = iUserFunctions.find(aOperator);
+    LispMultiUserFunction* multiUserFunc = aOperator->iSymbol.iUserFunction;
 
-    if (i == iUserFunctions.end())
+    if (!multiUserFunc)
         throw LispErrCreatingRule();
 
-    LispMultiUserFunction* multiUserFunc = &i->second;
-
     // Get the specific user function with the right arity
     LispUserFunction* userFunc = multiUserFunc->UserFunc(aArity);
 
@@ -501,6 +531,8 @@ void LispEnvironment::DefineRulePattern(const LispString* aOperator,
 
     // Declare a new evaluation rule
     userFunc->DeclarePattern(aPrecedence, aPredicate, aBody);
+
+    iRuleBaseGeneration++;
 }
 
 void LispEnvironment::SetCommand(YacasEvalCaller aEvaluatorFunc,
@@ -510,16 +542,22 @@ void LispEnvironment::SetCommand(YacasEvalCaller aEvaluatorFunc,
 {
     const LispString* name = HashTable().LookUp(aString);
     YacasEvaluator eval(aEvaluatorFunc, aNrArgs, aFlags);
-    auto i = iCoreCommands.find(name);
-    if (i != iCoreCommands.end())
-        i->second = eval;
+    if (name->iSymbol.iCoreCommand)
+        iCoreCommands.find(name)->second = eval;
     else
-        iCoreCommands.insert(std::make_pair(name, eval));
+        name->iSymbol.iCoreCommand =
+            &iCoreCommands.insert(std::make_pair(name, eval)).first->second;
+
+    iRuleBaseGeneration++;
 }
 
 void LispEnvironment::RemoveCoreCommand(char* aString)
 {
-    iCoreCommands.erase(HashTable().LookUp(aString));
+    const LispString* name = HashTable().LookUp(aString);
+    iCoreCommands.erase(name);
+    name->iSymbol.iCoreCommand = nullptr;
+
+    iRuleBaseGeneration++;
 }
 
 LispLocalEvaluator::LispLocalEvaluator(LispEnvironment& aEnvironment,
@@ -31,11 +31,56 @@ LispUserFunction* GetUserFunction(LispEnvironment& aEnvironment,
     return userFunc;
 }
 
+const EvalFuncBase* ResolveCall(LispEnvironment& aEnvironment,
+                                LispObject* aExpression,
+                                LispPtr* subList)
+{
+    const LispString* head = (*subList)->String();
+    LispCallSite* site = aExpression->CallSite();
+
+    // Fast path: the list was evaluated before, and nothing has been
+    // (re)defined since.
+    if (site && site->iGeneration == aEnvironment.iRuleBaseGeneration &&
+        site->iHead == head) {
+        assert(site->iArity < 0 ||
+               site->iArity ==
+                   static_cast<int>(InternalListLength(*subList)) - 1);
+        return site->iTarget;
+    }
+
+    const EvalFuncBase* target = nullptr;
+    int arity = -1;
+
+    if (const YacasEvaluator* command = aEnvironment.CoreCommand(head)) {
+        target = command;
+    } else {
+        target = GetUserFunction(aEnvironment, subList);
+        arity = InternalListLength(*subList) - 1;
+    }
+
+    // GetUserFunction() may have loaded a file, so pick up the current
+    // generation only now.
+    if (site && target) {
+        site->iHead = head;
+        site->iArity = arity;
+        site->iGeneration = aEnvironment.iRuleBaseGeneration;
+        site->iTarget = target;
+    }
+
+    return target;
+}
+
 UserStackInformation& LispEvaluatorBase::StackInformation()
 {
     return iBasicInfo;
 }
 
+bool LispEvaluatorBase::TailCall(LispEnvironment& /*aEnvironment*/,
+                                 LispPtr& /*aExpression*/)
+{
+    return true;
+}
+
 void LispEvaluatorBase::ResetStack() {}
 
 void LispEvaluatorBase::ShowStack(LispEnvironment& aEnvironment,
@@ -43,6 +88,13 @@ void LispEvaluatorBase::ShowStack(LispEnvironment& aEnvironment,
 {
 }
 
+void LispEvaluatorBase::EvalShared(LispEnvironment& aEnvironment,
+                                   LispPtr& aResult,
+                                   LispPtr& aExpression)
+{
+    Eval(aEnvironment, aResult, aExpression);
+}
+
 // Eval: evaluates an expression. The result of this operation must
 // be a unique (copied) element! Eg. its Nixed might be set...
 void BasicEvaluator::Eval(LispEnvironment& aEnvironment,
@@ -51,75 +103,104 @@ void BasicEvaluator::Eval(LispEnvironment& aEnvironment,
 {
     assert(aExpression);
 
+    CheckInterrupt(aEnvironment);
+
+    aEnvironment.iEvalDepth++;
+    if (aEnvironment.iEvalDepth >= aEnvironment.iMaxEvalDepth) {
+        ShowStack(aEnvironment, aEnvironment.CurrentOutput());
+        throw LispErrMaxRecurseDepthReached();
+    }
+
+    EvalStep(aEnvironment, aResult, aExpression);
+
+    aEnvironment.iEvalDepth--;
+}
+
+void BasicEvaluator::CheckInterrupt(LispEnvironment& aEnvironment)
+{
     if (aEnvironment.stop_evaluation) {
         aEnvironment.stop_evaluation = false;
         ShowStack(aEnvironment, aEnvironment.CurrentOutput());
         throw LispErrUserInterrupt();
     }
 
-    aEnvironment.iEvalDepth++;
-    if (aEnvironment.iEvalDepth >= aEnvironment.iMaxEvalDepth) {
-        ShowStack(aEnvironment, aEnvironment.CurrentOutput());
-        throw LispErrMaxRecurseDepthReached();
+    if (aEnvironment.iMemoryAccount.iExceeded) {
+        aEnvironment.iMemoryAccount.iExceeded = false;
+        throw LispErrNotEnoughMemory();
     }
+}
 
+void BasicEvaluator::EvalStep(LispEnvironment& aEnvironment,
+                              LispPtr& aResult,
+                              LispPtr& aExpression)
+{
     const LispString* str = aExpression->String();
 
     // Evaluate an atom: find the bound value (treat it as a variable)
     if (str) {
         if (str->front() == '\"') {
             aResult = aExpression->Copy();
-            goto FINISH;
+            return;
         }
 
         LispPtr val;
         aEnvironment.GetVariable(str, val);
         if (!!val) {
             aResult = (val->Copy());
-            goto FINISH;
+            return;
         }
         aResult = (aExpression->Copy());
-        goto FINISH;
+        return;
     }
 
-    {
-        LispPtr* subList = aExpression->SubList();
-
-        if (subList) {
-            LispObject* head = (*subList);
-            if (head) {
-                if (head->String()) {
-                    {
-                        const auto i =
-                            aEnvironment.CoreCommands().find(head->String());
-                        if (i != aEnvironment.CoreCommands().end()) {
-                            i->second.Evaluate(aResult, aEnvironment, *subList);
-                            goto FINISH;
-                        }
-                    }
-
-                    {
-                        LispUserFunction* userFunc;
-                        userFunc = GetUserFunction(aEnvironment, subList);
-                        if (userFunc) {
-                            userFunc->Evaluate(aResult, aEnvironment, *subList);
-                            goto FINISH;
-                        }
-                    }
-                } else {
-                    LispPtr oper((*subList));
-                    LispPtr args2((*subList)->Nixed());
-                    InternalApplyPure(oper, args2, aResult, aEnvironment);
-                    goto FINISH;
+    LispPtr* subList = aExpression->SubList();
+
+    if (subList) {
+        LispObject* head = (*subList);
+        if (head) {
+            if (head->String()) {
+                const EvalFuncBase* func =
+                    ResolveCall(aEnvironment, aExpression, subList);
+                if (func) {
+                    func->Evaluate(aResult, aEnvironment, *subList);
+                    return;
                 }
-                ReturnUnEvaluated(aResult, *subList, aEnvironment);
-                goto FINISH;
+            } else {
+                LispPtr oper((*subList));
+                LispPtr args2((*subList)->Nixed());
+                InternalApplyPure(oper, args2, aResult, aEnvironment);
+                return;
             }
+            ReturnUnEvaluated(aResult, *subList, aEnvironment);
+            return;
         }
-        aResult = (aExpression->Copy());
     }
-FINISH:
-    aEnvironment.iEvalDepth--;
+    aResult = (aExpression->Copy());
+}
+
+// The copy Eval() makes of an atom only serves to give the result a
+// Nixed of its own. A caller that leaves Nixed alone can do with the
+// original, as long as it is not linked to anything itself.
+void BasicEvaluator::EvalShared(LispEnvironment& aEnvironment,
+                                LispPtr& aResult,
+                                LispPtr& aExpression)
+{
+    const LispString* str = aExpression->String();
+
+    if (str && !aEnvironment.stop_evaluation) {
+        if (str->front() != '\"')
+            aEnvironment.GetVariable(str, aResult);
+        else
+            aResult = nullptr;
+
+        if (!aResult)
+            aResult = aExpression;
+
+        if (!aResult->Nixed())
+            return;
+    }
+
+    Eval(aEnvironment, aResult, aExpression);
 }
 
 void ShowExpression(LispString& outString,
@@ -239,8 +320,7 @@ void TracedStackEvaluator::ShowStack(LispEnvironment& aEnvironment,
 
         int internal;
         internal =
-            aEnvironment.CoreCommands().find(objs[i]->iOperator->String()) !=
-            aEnvironment.CoreCommands().end();
+            aEnvironment.CoreCommand(objs[i]->iOperator->String()) != nullptr;
         if (internal) {
             aEnvironment.CurrentOutput() << " (Internal function) ";
         } else {
@@ -303,6 +383,34 @@ void TracedStackEvaluator::Eval(LispEnvironment& aEnvironment,
     }
 }
 
+bool TracedStackEvaluator::TailCall(LispEnvironment& aEnvironment,
+                                    LispPtr& aExpression)
+{
+    if (objs.empty())
+        return true;
+
+    UserStackInformation& st = StackInformation();
+    st.iOperator =
+        LispAtom::New(aEnvironment, *(*aExpression->SubList())->String());
+    st.iExpression = aExpression;
+    st.iRulePrecedence = -1;
+    st.iSide = 0;
+    return true;
+}
+
+bool TracedEvaluator::TailCall(LispEnvironment& /*aEnvironment*/,
+                               LispPtr& /*aExpression*/)
+{
+    return false;
+}
+
+void TracedEvaluator::EvalShared(LispEnvironment& aEnvironment,
+                                 LispPtr& aResult,
+                                 LispPtr& aExpression)
+{
+    Eval(aEnvironment, aResult, aExpression);
+}
+
 void TracedEvaluator::Eval(LispEnvironment& aEnvironment,
                            LispPtr& aResult,
                            LispPtr& aExpression)
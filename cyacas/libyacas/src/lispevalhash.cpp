@@ -36,13 +36,13 @@ void YacasEvaluator::Evaluate(LispPtr& aResult,
             if (!iter.getObj())
                 throw LispErrWrongNumberOfArgs();
 
-            aEnvironment.iStack.push_back(LispPtr(iter.getObj()->Copy()));
+            aEnvironment.iStack.emplace_back(iter.getObj()->Copy());
             ++iter;
         }
         if (iFlags & Variable) {
             LispPtr head(aEnvironment.iList->Copy());
             head->Nixed() = (iter.getObj());
-            aEnvironment.iStack.push_back(LispPtr(LispSubList::New(head)));
+            aEnvironment.iStack.emplace_back(LispSubList::New(head));
         }
     } else {
         LispPtr arg;
@@ -50,8 +50,11 @@ void YacasEvaluator::Evaluate(LispPtr& aResult,
             if (!iter.getObj())
                 throw LispErrWrongNumberOfArgs();
 
-            aEnvironment.iEvaluator->Eval(aEnvironment, arg, *iter);
-            aEnvironment.iStack.push_back(arg);
+            if (iFlags & Shared)
+                aEnvironment.iEvaluator->EvalShared(aEnvironment, arg, *iter);
+            else
+                aEnvironment.iEvaluator->Eval(aEnvironment, arg, *iter);
+            aEnvironment.iStack.push_back(std::move(arg));
             ++iter;
         }
         if (iFlags & Variable) {
@@ -60,11 +63,11 @@ void YacasEvaluator::Evaluate(LispPtr& aResult,
             LispPtr list(LispSubList::New(head));
 
             aEnvironment.iEvaluator->Eval(aEnvironment, arg, list);
-            aEnvironment.iStack.push_back(arg);
+            aEnvironment.iStack.push_back(std::move(arg));
         }
     }
 
     iCaller(aEnvironment, stacktop);
-    aResult = (aEnvironment.iStack[stacktop]);
+    aResult = std::move(aEnvironment.iStack[stacktop]);
     aEnvironment.iStack.resize(stacktop);
 }
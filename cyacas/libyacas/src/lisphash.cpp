@@ -1,20 +1,161 @@
 #include "yacas/lisphash.h"
 
-const LispString* LispHashTable::LookUp(const std::string& s)
+#include <functional>
+
+namespace {
+    // Capacity is a power of two, kept at most half full
+    const std::size_t MIN_CAPACITY = 1024;
+
+    // Insertions between two collection steps
+    const std::size_t YOUNG_GENERATION = 256;
+
+    // Slots of the table swept per collection step
+    const std::size_t SWEEP_SLOTS = 2 * YOUNG_GENERATION;
+}
+
+LispHashTable::LispHashTable():
+    _slots(MIN_CAPACITY),
+    _size(0),
+    _cursor(0),
+    _stats()
+{
+    _young.reserve(YOUNG_GENERATION);
+}
+
+// Index of the slot holding s, or of the empty slot where it belongs
+std::size_t LispHashTable::Probe(std::size_t hash, std::string_view s) const
+{
+    const std::size_t mask = _slots.size() - 1;
+
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = _slots[i];
+
+        if (!slot.string)
+            return i;
+
+        if (slot.hash == hash && std::string_view(*slot.string) == s)
+            return i;
+    }
+}
+
+const LispString* LispHashTable::LookUp(std::string_view s)
+{
+    const std::size_t hash = std::hash<std::string_view>()(s);
+
+    std::size_t i = Probe(hash, s);
+
+    if (_slots[i].string)
+        return _slots[i].string;
+
+    if (2 * (_size + 1) > _slots.size()) {
+        Rehash(2 * _slots.size());
+        i = Probe(hash, s);
+    }
+
+    _slots[i].hash = hash;
+    _slots[i].string = new LispString(std::string(s));
+    _size += 1;
+
+    _young.push_back(_slots[i].string);
+    _stats.young = _young.size();
+
+    return _slots[i].string;
+}
+
+void LispHashTable::Rehash(std::size_t capacity)
+{
+    std::vector<Slot> old(capacity);
+    old.swap(_slots);
+
+    const std::size_t mask = _slots.size() - 1;
+
+    for (Slot& slot : old) {
+        if (!slot.string)
+            continue;
+
+        std::size_t i = slot.hash & mask;
+        while (_slots[i].string)
+            i = (i + 1) & mask;
+
+        _slots[i].hash = slot.hash;
+        _slots[i].string = slot.string;
+    }
+
+    _cursor &= mask;
+}
+
+// Empty slot i, and move later strings of the same probe sequence back
+// so that none of them ends up behind an empty slot.
+void LispHashTable::Remove(std::size_t i)
+{
+    const std::size_t mask = _slots.size() - 1;
+
+    _slots[i].string = nullptr;
+    _size -= 1;
+    _stats.collected += 1;
+
+    for (std::size_t j = (i + 1) & mask; _slots[j].string; j = (j + 1) & mask) {
+        const std::size_t home = _slots[j].hash & mask;
+
+        // Stay if home lies cyclically in (i, j]
+        if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+            continue;
+
+        _slots[i].hash = _slots[j].hash;
+        _slots[i].string = _slots[j].string;
+        _slots[j].string = nullptr;
+        i = j;
+    }
+}
+
+void LispHashTable::CollectYoung()
+{
+    for (const LispString* s : _young) {
+        if (s->use_count() > 1) {
+            _stats.retained += 1;
+            continue;
+        }
+
+        std::size_t i = Probe(std::hash<std::string_view>()(*s), *s);
+        Remove(i);
+    }
+
+    _young.clear();
+    _stats.young = 0;
+}
+
+void LispHashTable::Sweep(std::size_t aSlots)
+{
+    const std::size_t mask = _slots.size() - 1;
+
+    // After a removal the slot may hold a string moved back into it,
+    // so it is looked at again.
+    for (std::size_t n = 0; n < aSlots; ++n) {
+        const Slot& slot = _slots[_cursor];
+        if (slot.string && slot.string->use_count() == 1)
+            Remove(_cursor);
+        else
+            _cursor = (_cursor + 1) & mask;
+    }
+}
+
+void LispHashTable::CollectIncrementally()
 {
-    std::unordered_map<std::string, LispStringSmartPtr>::const_iterator i =
-        _rep.find(s);
-    if (i != _rep.end())
-        return i->second;
+    if (_young.size() < YOUNG_GENERATION)
+        return;
 
-    LispString* ls = new LispString(s);
+    // The young strings go first: the sweep must not dispose of a
+    // string _young still points to.
+    CollectYoung();
+    Sweep(SWEEP_SLOTS);
 
-    return _rep.insert(std::make_pair(s, ls)).first->second;
+    _stats.steps += 1;
 }
 
 void LispHashTable::GarbageCollect()
 {
-    for (auto i = _rep.begin(); i != _rep.end(); ++i)
-        while (i != _rep.end() && i->second->use_count() == 1)
-            i = _rep.erase(i);
+    CollectYoung();
+    Sweep(2 * _slots.size());
+
+    _stats.steps += 1;
 }
@@ -1,6 +1,99 @@
 
 #include "yacas/lispobject.h"
 
+#include <vector>
+
+namespace {
+    // Set once the worklist of the thread is gone; objects destroyed
+    // after that, on the way out, go on a worklist local to the
+    // outermost release instead.
+    thread_local bool finished = false;
+    thread_local std::vector<LispPtr>* draining = nullptr;
+
+    struct Pending {
+        ~Pending()
+        {
+            LispReclaimer::Collect(static_cast<std::size_t>(-1));
+            finished = true;
+        }
+
+        std::vector<LispPtr> objects;
+        bool collecting = false;
+    };
+
+    thread_local Pending pending;
+}
+
+LispObject::~LispObject()
+{
+    if (!!iNext)
+        LispReclaimer::Release(iNext);
+}
+
+void LispReclaimer::Release(LispPtr& aObject) noexcept
+{
+    if (aObject->use_count() == 1 && !finished) {
+        Pending& p = pending;
+
+        // Without room on the worklist the object is simply destroyed
+        // right here.
+        try {
+            p.objects.push_back(std::move(aObject));
+        } catch (...) {
+        }
+
+        if (!p.collecting)
+            Collect(SLICE);
+    } else if (finished && aObject->use_count() == 1) {
+        if (draining) {
+            try {
+                draining->push_back(std::move(aObject));
+            } catch (...) {
+            }
+        } else {
+            std::vector<LispPtr> objects;
+            draining = &objects;
+
+            try {
+                objects.push_back(std::move(aObject));
+            } catch (...) {
+            }
+
+            while (!objects.empty()) {
+                LispPtr victim(std::move(objects.back()));
+                objects.pop_back();
+            }
+
+            draining = nullptr;
+        }
+    }
+
+    aObject = nullptr;
+}
+
+std::size_t LispReclaimer::Collect(std::size_t aCount) noexcept
+{
+    if (finished)
+        return 0;
+
+    Pending& p = pending;
+
+    if (p.collecting)
+        return p.objects.size();
+
+    p.collecting = true;
+
+    // Destroying an object puts what it held on the worklist
+    for (; aCount && !p.objects.empty(); --aCount) {
+        LispPtr victim(std::move(p.objects.back()));
+        p.objects.pop_back();
+    }
+
+    p.collecting = false;
+
+    return p.objects.size();
+}
+
 int LispObject::Equal(LispObject& aOther)
 {
     // next line handles the fact that either one is a string
@@ -0,0 +1,15 @@
+#include "yacas/lispstring.h"
+#include "yacas/memoryaccount.h"
+
+LispString::~LispString()
+{
+    MemoryAccount::Charge(-static_cast<std::ptrdiff_t>(iCharged));
+}
+
+void LispString::Charge()
+{
+    const std::size_t bytes = sizeof(LispString) + capacity();
+    MemoryAccount::Charge(static_cast<std::ptrdiff_t>(bytes) -
+                          static_cast<std::ptrdiff_t>(iCharged));
+    iCharged = bytes;
+}
@@ -0,0 +1,72 @@
+#include "yacas/listindex.h"
+
+#include <functional>
+
+namespace {
+    // Shorter lists are walked, indexing them does not pay off
+    const std::size_t MIN_LENGTH = 16;
+
+    std::size_t Slot(const LispObject* p, std::size_t slots)
+    {
+        return std::hash<const LispObject*>()(p) % slots;
+    }
+}
+
+const ListIndexCache::Entry*
+ListIndexCache::Find(std::size_t aGeneration, const LispPtr& aFirst) const
+{
+    const Entry& e = _entries[Slot(aFirst, SLOTS)];
+
+    if (e.generation == aGeneration && e.first.ptr() == aFirst.ptr() &&
+        !e.elements.empty())
+        return &e;
+
+    return nullptr;
+}
+
+const ListIndexCache::Entry*
+ListIndexCache::Walk(std::size_t aGeneration, const LispPtr& aFirst)
+{
+    Entry& e = _entries[Slot(aFirst, SLOTS)];
+
+    if (e.generation != aGeneration || e.first.ptr() != aFirst.ptr()) {
+        if (e.first.ptr() != aFirst.ptr())
+            e.first = aFirst;
+        e.generation = aGeneration;
+        e.elements.clear();
+        return nullptr;
+    }
+
+    if (e.elements.empty())
+        for (LispObject* p = aFirst; p; p = p->Nixed())
+            e.elements.push_back(p);
+
+    return &e;
+}
+
+LispObject* ListIndexCache::Element(std::size_t aGeneration,
+                                    const LispPtr& aFirst,
+                                    std::size_t n)
+{
+    if (n >= MIN_LENGTH)
+        if (const Entry* e = Walk(aGeneration, aFirst))
+            return n < e->elements.size() ? e->elements[n] : nullptr;
+
+    LispObject* p = aFirst;
+    while (p && n--)
+        p = p->Nixed();
+
+    return p;
+}
+
+std::size_t ListIndexCache::Size(std::size_t aGeneration, const LispPtr& aFirst)
+{
+    if (const Entry* e = Find(aGeneration, aFirst))
+        return e->elements.size();
+
+    std::size_t size = 0;
+    for (LispObject* p = aFirst; p; p = p->Nixed())
+        size += 1;
+
+    return size;
+}
@@ -172,12 +172,22 @@ void LispStrictTotalOrder(LispEnvironment& aEnvironment, int aStackTop)
 
 void LispLessThan(LispEnvironment& aEnvironment, int aStackTop)
 {
-    LispLexCompare2(aEnvironment, aStackTop, LexLessThan, BigLessThan);
+    std::int64_t a, b;
+    if (LispNumber::SmallInteger(ARGUMENT(1), a) &&
+        LispNumber::SmallInteger(ARGUMENT(2), b))
+        InternalBoolean(aEnvironment, RESULT, a < b);
+    else
+        LispLexCompare2(aEnvironment, aStackTop, LexLessThan, BigLessThan);
 }
 
 void LispGreaterThan(LispEnvironment& aEnvironment, int aStackTop)
 {
-    LispLexCompare2(aEnvironment, aStackTop, LexGreaterThan, BigGreaterThan);
+    std::int64_t a, b;
+    if (LispNumber::SmallInteger(ARGUMENT(1), a) &&
+        LispNumber::SmallInteger(ARGUMENT(2), b))
+        InternalBoolean(aEnvironment, RESULT, a > b);
+    else
+        LispLexCompare2(aEnvironment, aStackTop, LexGreaterThan, BigGreaterThan);
 }
 
 void LispLexCompare2(LispEnvironment& aEnvironment,
@@ -229,7 +239,16 @@ void LispNth(LispEnvironment& aEnvironment, int aStackTop)
     CheckArg(str, 2, aEnvironment, aStackTop);
     CheckArg(IsNumber(str->c_str(), false), 2, aEnvironment, aStackTop);
     int index = InternalAsciiToInt(*str);
-    InternalNth(RESULT, ARGUMENT(1), index);
+
+    if (index < 0 || !ARGUMENT(1)->SubList())
+        throw LispErrInvalidArg();
+
+    LispObject* element = aEnvironment.iListIndex.Element(
+        aEnvironment.iListGeneration, *ARGUMENT(1)->SubList(), index);
+    if (!element)
+        throw LispErrInvalidArg();
+
+    RESULT = element->Copy();
 }
 
 void LispTail(LispEnvironment& aEnvironment, int aStackTop)
@@ -238,8 +257,8 @@ void LispTail(LispEnvironment& aEnvironment, int aStackTop)
     InternalTail(first, ARGUMENT(1));
     InternalTail(RESULT, first);
     LispPtr head(aEnvironment.iList->Copy());
-    head->Nixed() = ((*RESULT->SubList()));
-    (*RESULT->SubList()) = (head);
+    head->Nixed() = std::move(*RESULT->SubList());
+    (*RESULT->SubList()) = std::move(head);
 }
 
 void LispUnList(LispEnvironment& aEnvironment, int aStackTop)
@@ -263,12 +282,32 @@ void LispListify(LispEnvironment& aEnvironment, int aStackTop)
     RESULT = (LispSubList::New(head));
 }
 
+// Whether one of the first aCount elements of the list starting at
+// aFirst belongs to the hash-cons table, which shares them: their
+// links must not be changed, the destructive list functions refuse to.
+static bool IsConsed(LispObject* aFirst, std::size_t aCount)
+{
+    for (; aFirst && aCount > 0; aFirst = aFirst->Nixed(), --aCount)
+        if (aFirst->Consed())
+            return true;
+
+    return false;
+}
+
 void LispDestructiveReverse(LispEnvironment& aEnvironment, int aStackTop)
 {
     CheckArgIsList(1, aEnvironment, aStackTop);
 
     LispPtr reversed(aEnvironment.iList->Copy());
-    InternalReverseList(reversed->Nixed(), (*ARGUMENT(1)->SubList())->Nixed());
+
+    LispPtr& elements = (*ARGUMENT(1)->SubList())->Nixed();
+    CheckArg(!IsConsed(elements, static_cast<std::size_t>(-1)),
+             1,
+             aEnvironment,
+             aStackTop);
+
+    InternalReverseList(reversed->Nixed(), elements);
+    aEnvironment.iListGeneration++;
     RESULT = (LispSubList::New(reversed));
 }
 
@@ -276,8 +315,9 @@ void LispLength(LispEnvironment& aEnvironment, int aStackTop)
 {
     std::size_t size = 0;
 
-    if (LispPtr* subList = ARGUMENT(1)->SubList()) {
-        size = InternalListLength((*subList)->Nixed());
+    if (ARGUMENT(1)->SubList()) {
+        size = aEnvironment.iListIndex.Size(aEnvironment.iListGeneration,
+                                            *ARGUMENT(1)->SubList()) - 1;
     } else if (InternalIsString(ARGUMENT(1)->String())) {
         size = ARGUMENT(1)->String()->size() - 2;
     } else if (ArrayClass* arr =
@@ -301,8 +341,7 @@ void LispList(LispEnvironment& aEnvironment, int aStackTop)
     while ((++iter).getObj()) {
         LispPtr evaluated;
         InternalEval(aEnvironment, evaluated, *iter);
-        // Ideally this would work, but it does not yet: (*tail++) = (evaluated)
-        (*tail) = (evaluated);
+        (*tail) = std::move(evaluated);
         ++tail;
     }
     RESULT = (LispSubList::New(all));
@@ -348,19 +387,24 @@ InternalDelete(LispEnvironment& aEnvironment, int aStackTop, int aDestructive)
     LispPtr evaluated(ARGUMENT(1));
     CheckArgIsList(1, aEnvironment, aStackTop);
 
+    LispPtr index(ARGUMENT(2));
+    CheckArg(index, 2, aEnvironment, aStackTop);
+    CheckArg(index->String(), 2, aEnvironment, aStackTop);
+    int ind = InternalAsciiToInt(*index->String());
+    CheckArg(ind > 0, 2, aEnvironment, aStackTop);
+
     LispPtr copied;
     if (aDestructive) {
+        CheckArg(!IsConsed(*evaluated->SubList(), ind),
+                 1,
+                 aEnvironment,
+                 aStackTop);
         copied = ((*evaluated->SubList()));
+        aEnvironment.iListGeneration++;
     } else {
         InternalFlatCopy(copied, *evaluated->SubList());
     }
 
-    LispPtr index(ARGUMENT(2));
-    CheckArg(index, 2, aEnvironment, aStackTop);
-    CheckArg(index->String(), 2, aEnvironment, aStackTop);
-    int ind = InternalAsciiToInt(*index->String());
-    CheckArg(ind > 0, 2, aEnvironment, aStackTop);
-
     LispIterator iter(copied);
     while (--ind >= 0)
         ++iter;
@@ -401,25 +445,30 @@ InternalInsert(LispEnvironment& aEnvironment, int aStackTop, int aDestructive)
 
     LispPtr evaluated(ARGUMENT(1));
 
+    LispPtr index(ARGUMENT(2));
+    CheckArg(index, 2, aEnvironment, aStackTop);
+    CheckArg(index->String(), 2, aEnvironment, aStackTop);
+    int ind = InternalAsciiToInt(*index->String());
+    CheckArg(ind > 0, 2, aEnvironment, aStackTop);
+
     LispPtr copied;
     if (aDestructive) {
+        CheckArg(!IsConsed(*evaluated->SubList(), ind),
+                 1,
+                 aEnvironment,
+                 aStackTop);
         copied = ((*evaluated->SubList()));
+        aEnvironment.iListGeneration++;
     } else {
         InternalFlatCopy(copied, *evaluated->SubList());
     }
 
-    LispPtr index(ARGUMENT(2));
-    CheckArg(index, 2, aEnvironment, aStackTop);
-    CheckArg(index->String(), 2, aEnvironment, aStackTop);
-    int ind = InternalAsciiToInt(*index->String());
-    CheckArg(ind > 0, 2, aEnvironment, aStackTop);
-
     LispIterator iter(copied);
     while (--ind >= 0)
         ++iter;
     LispPtr toInsert(ARGUMENT(3));
-    toInsert->Nixed() = (iter.getObj());
-    (*iter) = (toInsert);
+    toInsert->Nixed() = std::move(*iter);
+    (*iter) = std::move(toInsert);
     RESULT = (LispSubList::New(copied));
 }
 
@@ -447,13 +496,19 @@ InternalReplace(LispEnvironment& aEnvironment, int aStackTop, int aDestructive)
     CheckArg(index->String(), 2, aEnvironment, aStackTop);
     int ind = InternalAsciiToInt(*index->String());
 
+    CheckArg(ind > 0, 2, aEnvironment, aStackTop);
+
     LispPtr copied;
     if (aDestructive) {
+        CheckArg(!IsConsed(*evaluated->SubList(), ind),
+                 1,
+                 aEnvironment,
+                 aStackTop);
         copied = ((*evaluated->SubList()));
+        aEnvironment.iListGeneration++;
     } else {
         InternalFlatCopy(copied, *evaluated->SubList());
     }
-    CheckArg(ind > 0, 2, aEnvironment, aStackTop);
 
     LispIterator iter(copied);
     while (--ind >= 0)
@@ -463,7 +518,7 @@ InternalReplace(LispEnvironment& aEnvironment, int aStackTop, int aDestructive)
 
     LispIterator temp = iter++;
     toInsert->Nixed() = (*iter);
-    (*temp) = (toInsert);
+    (*temp) = std::move(toInsert);
     RESULT = (LispSubList::New(copied));
 }
 
@@ -1557,6 +1612,7 @@ void GenArrayCreate(LispEnvironment& aEnvironment, int aStackTop)
 
     ArrayClass* array = new ArrayClass(size, initarg);
     RESULT = (LispGenericClass::New(array));
+    aEnvironment.iCycleCollector.Track(array);
 }
 
 void GenArraySize(LispEnvironment& aEnvironment, int aStackTop)
@@ -1619,6 +1675,7 @@ void GenAssociationCreate(LispEnvironment& aEnvironment, int aStackTop)
 {
     AssociationClass* a = new AssociationClass(aEnvironment);
     RESULT = LispGenericClass::New(a);
+    aEnvironment.iCycleCollector.Track(a);
 }
 
 void GenAssociationSize(LispEnvironment& aEnvironment, int aStackTop)
@@ -1776,6 +1833,20 @@ void LispTraceStack(LispEnvironment& aEnvironment, int aStackTop)
     InternalEval(aEnvironment, RESULT, ARGUMENT(1));
 }
 
+void LispSegmentedStack(LispEnvironment& aEnvironment, int aStackTop)
+{
+    LispLocalEvaluator local(aEnvironment, new SegmentedStackEvaluator);
+
+    // An error may leave any depth behind, far beyond MaxEvalDepth
+    const int depth = aEnvironment.iEvalDepth;
+    try {
+        InternalEval(aEnvironment, RESULT, ARGUMENT(1));
+    } catch (...) {
+        aEnvironment.iEvalDepth = depth;
+        throw;
+    }
+}
+
 void LispReadLisp(LispEnvironment& aEnvironment, int aStackTop)
 {
     LispTokenizer& tok = *aEnvironment.iCurrentTokenizer;
@@ -22,7 +22,10 @@
 
 #include "yacas/yacas_version.h"
 
+#include <cstdint>
 #include <iomanip>
+#include <iterator>
+#include <limits>
 #include <sstream>
 
 #define InternalEval aEnvironment.iEvaluator->Eval
@@ -43,6 +46,51 @@ void GetNumber(RefPtr<BigNumber>& x,
     CheckArg(x, aArgNr, aEnvironment, aStackTop);
 }
 
+namespace {
+    // Machine word arithmetic on small integers; false if the result
+    // does not fit, and needs a BigNumber.
+    bool SmallAdd(std::int64_t a, std::int64_t b, std::int64_t& r)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return !__builtin_add_overflow(a, b, &r);
+#else
+        if ((b > 0 && a > std::numeric_limits<std::int64_t>::max() - b) ||
+            (b < 0 && a < std::numeric_limits<std::int64_t>::min() - b))
+            return false;
+        r = a + b;
+        return true;
+#endif
+    }
+
+    bool SmallSubtract(std::int64_t a, std::int64_t b, std::int64_t& r)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return !__builtin_sub_overflow(a, b, &r);
+#else
+        if ((b < 0 && a > std::numeric_limits<std::int64_t>::max() + b) ||
+            (b > 0 && a < std::numeric_limits<std::int64_t>::min() + b))
+            return false;
+        r = a - b;
+        return true;
+#endif
+    }
+
+    bool SmallMultiply(std::int64_t a, std::int64_t b, std::int64_t& r)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return !__builtin_mul_overflow(a, b, &r);
+#else
+        const std::int64_t max = std::numeric_limits<std::int64_t>::max();
+        const std::int64_t min = std::numeric_limits<std::int64_t>::min();
+        if (a > 0 ? (b > 0 ? a > max / b : b < min / a)
+                  : (b > 0 ? a < min / b : a != 0 && b < max / a))
+            return false;
+        r = a * b;
+        return true;
+#endif
+    }
+}
+
 // FIXME remove these
 void LispArithmetic2(LispEnvironment& aEnvironment,
                      int aStackTop,
@@ -96,6 +144,13 @@ void LispDumpBigNumberDebugInfo(LispEnvironment& aEnvironment, int aStackTop)
 
 void LispMultiply(LispEnvironment& aEnvironment, int aStackTop)
 {
+    std::int64_t a, b, c;
+    if (LispNumber::SmallInteger(ARGUMENT(1), a) &&
+        LispNumber::SmallInteger(ARGUMENT(2), b) && SmallMultiply(a, b, c)) {
+        RESULT = new LispNumber(c);
+        return;
+    }
+
     RefPtr<BigNumber> x;
     RefPtr<BigNumber> y;
     GetNumber(x, aEnvironment, aStackTop, 1);
@@ -131,6 +186,13 @@ void LispAdd(LispEnvironment& aEnvironment, int aStackTop)
         RESULT = (new LispNumber(x.ptr()));
         return;
     } else {
+        std::int64_t a, b, c;
+        if (LispNumber::SmallInteger(ARGUMENT(1), a) &&
+            LispNumber::SmallInteger(ARGUMENT(2), b) && SmallAdd(a, b, c)) {
+            RESULT = new LispNumber(c);
+            return;
+        }
+
         RefPtr<BigNumber> x;
         RefPtr<BigNumber> y;
         GetNumber(x, aEnvironment, aStackTop, 1);
@@ -147,6 +209,12 @@ void LispSubtract(LispEnvironment& aEnvironment, int aStackTop)
 {
     int length = InternalListLength(ARGUMENT(0));
     if (length == 2) {
+        std::int64_t a, c;
+        if (LispNumber::SmallInteger(ARGUMENT(1), a) && SmallSubtract(0, a, c)) {
+            RESULT = new LispNumber(c);
+            return;
+        }
+
         RefPtr<BigNumber> x;
         GetNumber(x, aEnvironment, aStackTop, 1);
         BigNumber* z = new BigNumber(*x);
@@ -154,6 +222,13 @@ void LispSubtract(LispEnvironment& aEnvironment, int aStackTop)
         RESULT = (new LispNumber(z));
         return;
     } else {
+        std::int64_t a, b, c;
+        if (LispNumber::SmallInteger(ARGUMENT(1), a) &&
+            LispNumber::SmallInteger(ARGUMENT(2), b) && SmallSubtract(a, b, c)) {
+            RESULT = new LispNumber(c);
+            return;
+        }
+
         RefPtr<BigNumber> x;
         RefPtr<BigNumber> y;
         GetNumber(x, aEnvironment, aStackTop, 1);
@@ -444,7 +519,8 @@ void LispFromBase(LispEnvironment& aEnvironment, int aStackTop)
 
     // Added, unquote a string
     CheckArg(InternalIsString(str2), 2, aEnvironment, aStackTop);
-    str2 = aEnvironment.HashTable().LookUp(str2->substr(1, str2->length() - 2));
+    str2 = aEnvironment.HashTable().LookUp(
+        std::string_view(*str2).substr(1, str2->length() - 2));
 
     // convert using correct base
     // FIXME: API breach, must pass precision in base digits and not in bits!
@@ -559,10 +635,216 @@ void YacasPrettyPrinterGet(LispEnvironment& aEnvironment, int aStackTop)
 
 void LispGarbageCollect(LispEnvironment& aEnvironment, int aStackTop)
 {
+    LispReclaimer::Collect(static_cast<std::size_t>(-1));
     aEnvironment.HashTable().GarbageCollect();
     InternalTrue(aEnvironment, RESULT);
 }
 
+void LispSymbolTableStatistics(LispEnvironment& aEnvironment, int aStackTop)
+{
+    const LispHashTable& hash = aEnvironment.HashTable();
+    const LispHashTable::Statistics& stats = hash.Stats();
+
+    const std::pair<const char*, std::size_t> entries[] = {
+        {"\"size\"", hash.Size()},
+        {"\"young\"", stats.young},
+        {"\"collected\"", stats.collected},
+        {"\"retained\"", stats.retained},
+        {"\"steps\"", stats.steps}
+    };
+
+    LispPtr result;
+    for (auto i = std::rbegin(entries); i != std::rend(entries); ++i) {
+        LispObject* entry = LispSubList::New(
+            LispObjectAdder(aEnvironment.iList->Copy()) +
+            LispObjectAdder(LispAtom::New(aEnvironment, i->first)) +
+            LispObjectAdder(
+                LispAtom::New(aEnvironment, std::to_string(i->second))));
+        entry->Nixed() = result;
+        result = entry;
+    }
+
+    RESULT = LispSubList::New(LispObjectAdder(aEnvironment.iList->Copy()) +
+                              LispObjectAdder(result));
+}
+
+void LispHashCons(LispEnvironment& aEnvironment, int aStackTop)
+{
+    RESULT = aEnvironment.iHashCons.Cons(aEnvironment, ARGUMENT(1));
+}
+
+void LispCycleCollectorRun(LispEnvironment& aEnvironment, int aStackTop)
+{
+    const CycleCollector::Statistics stats =
+        aEnvironment.iCycleCollector.Collect();
+
+    const std::pair<const char*, std::size_t> entries[] = {
+        {"\"cycles\"", stats.cycles},
+        {"\"containers\"", stats.containers},
+        {"\"objects\"", stats.objects},
+        {"\"bytes\"", stats.bytes}
+    };
+
+    LispPtr result;
+    for (auto i = std::rbegin(entries); i != std::rend(entries); ++i) {
+        LispObject* entry = LispSubList::New(
+            LispObjectAdder(aEnvironment.iList->Copy()) +
+            LispObjectAdder(LispAtom::New(aEnvironment, i->first)) +
+            LispObjectAdder(
+                LispAtom::New(aEnvironment, std::to_string(i->second))));
+        entry->Nixed() = result;
+        result = entry;
+    }
+
+    RESULT = LispSubList::New(LispObjectAdder(aEnvironment.iList->Copy()) +
+                              LispObjectAdder(result));
+}
+
+void LispCycleCollectorSet(LispEnvironment& aEnvironment, int aStackTop)
+{
+    LispPtr evaluated(ARGUMENT(1));
+    const LispString* string = evaluated->String();
+    CheckArg(string, 1, aEnvironment, aStackTop);
+    CheckArg(IsNumber(string->c_str(), false), 1, aEnvironment, aStackTop);
+
+    const int threshold = InternalAsciiToInt(*string);
+    CheckArg(threshold >= 0, 1, aEnvironment, aStackTop);
+
+    aEnvironment.iCycleCollector.iThreshold = threshold;
+    InternalTrue(aEnvironment, RESULT);
+}
+
+void LispCycleCollectorGet(LispEnvironment& aEnvironment, int aStackTop)
+{
+    RESULT = LispAtom::New(
+        aEnvironment, std::to_string(aEnvironment.iCycleCollector.iThreshold));
+}
+
+void LispMemoryAccountStatistics(LispEnvironment& aEnvironment, int aStackTop)
+{
+    const MemoryAccount& account = aEnvironment.iMemoryAccount;
+
+    const std::pair<const char*, std::size_t> entries[] = {
+        {"\"current\"", account.Current()},
+        {"\"peak\"", account.Peak()},
+        {"\"limit\"", account.Limit()}
+    };
+
+    LispPtr result;
+    for (auto i = std::rbegin(entries); i != std::rend(entries); ++i) {
+        LispObject* entry = LispSubList::New(
+            LispObjectAdder(aEnvironment.iList->Copy()) +
+            LispObjectAdder(LispAtom::New(aEnvironment, i->first)) +
+            LispObjectAdder(
+                LispAtom::New(aEnvironment, std::to_string(i->second))));
+        entry->Nixed() = result;
+        result = entry;
+    }
+
+    RESULT = LispSubList::New(LispObjectAdder(aEnvironment.iList->Copy()) +
+                              LispObjectAdder(result));
+}
+
+void LispMemoryAccountSet(LispEnvironment& aEnvironment, int aStackTop)
+{
+    LispPtr evaluated(ARGUMENT(1));
+    const LispString* string = evaluated->String();
+    CheckArg(string, 1, aEnvironment, aStackTop);
+    CheckArg(IsNumber(string->c_str(), false), 1, aEnvironment, aStackTop);
+    CheckArg(string->front() != '-' && string->size() < 20,
+             1,
+             aEnvironment,
+             aStackTop);
+
+    aEnvironment.iMemoryAccount.SetLimit(std::stoull(*string));
+    InternalTrue(aEnvironment, RESULT);
+}
+
+void LispMemoryAccountGet(LispEnvironment& aEnvironment, int aStackTop)
+{
+    RESULT = LispAtom::New(
+        aEnvironment, std::to_string(aEnvironment.iMemoryAccount.Limit()));
+}
+
+namespace {
+    // The function named by the first argument, with the arity given by
+    // the second one
+    BranchingUserFunction* MemoizedFunction(LispEnvironment& aEnvironment,
+                                            int aStackTop)
+    {
+        CheckArg(ARGUMENT(1), 1, aEnvironment, aStackTop);
+        const LispString* orig = ARGUMENT(1)->String();
+        CheckArg(orig, 1, aEnvironment, aStackTop);
+
+        CheckArg(ARGUMENT(2), 2, aEnvironment, aStackTop);
+        const LispString* arity = ARGUMENT(2)->String();
+        CheckArg(arity, 2, aEnvironment, aStackTop);
+        CheckArg(IsNumber(arity->c_str(), false), 2, aEnvironment, aStackTop);
+
+        LispUserFunction* userFunc = aEnvironment.UserFunction(
+            SymbolName(aEnvironment, *orig), InternalAsciiToInt(*arity));
+
+        // Macros evaluate their body in the caller's scope, their results
+        // can not be remembered
+        BranchingUserFunction* branching =
+            dynamic_cast<BranchingUserFunction*>(userFunc);
+        if (!branching || dynamic_cast<MacroUserFunction*>(userFunc))
+            throw LispErrInvalidArg();
+
+        return branching;
+    }
+}
+
+void LispMemoize(LispEnvironment& aEnvironment, int aStackTop)
+{
+    MemoizedFunction(aEnvironment, aStackTop)->Memoize();
+    InternalTrue(aEnvironment, RESULT);
+}
+
+void LispMemoizeSet(LispEnvironment& aEnvironment, int aStackTop)
+{
+    BranchingUserFunction* userFunc = MemoizedFunction(aEnvironment, aStackTop);
+
+    LispPtr evaluated(ARGUMENT(3));
+    const LispString* string = evaluated->String();
+    CheckArg(string, 3, aEnvironment, aStackTop);
+    CheckArg(IsNumber(string->c_str(), false), 3, aEnvironment, aStackTop);
+
+    const int capacity = InternalAsciiToInt(*string);
+    CheckArg(capacity >= 0, 3, aEnvironment, aStackTop);
+
+    userFunc->Memoize();
+    userFunc->Memo()->SetCapacity(capacity);
+    InternalTrue(aEnvironment, RESULT);
+}
+
+void LispMemoizeStatistics(LispEnvironment& aEnvironment, int aStackTop)
+{
+    const MemoTable* memo = MemoizedFunction(aEnvironment, aStackTop)->Memo();
+    CheckArg(memo, 1, aEnvironment, aStackTop);
+
+    const std::pair<const char*, std::size_t> entries[] = {
+        {"\"hits\"", memo->Hits()},
+        {"\"misses\"", memo->Misses()},
+        {"\"size\"", memo->Size()},
+        {"\"capacity\"", memo->Capacity()}
+    };
+
+    LispPtr result;
+    for (auto i = std::rbegin(entries); i != std::rend(entries); ++i) {
+        LispObject* entry = LispSubList::New(
+            LispObjectAdder(aEnvironment.iList->Copy()) +
+            LispObjectAdder(LispAtom::New(aEnvironment, i->first)) +
+            LispObjectAdder(
+                LispAtom::New(aEnvironment, std::to_string(i->second))));
+        entry->Nixed() = result;
+        result = entry;
+    }
+
+    RESULT = LispSubList::New(LispObjectAdder(aEnvironment.iList->Copy()) +
+                              LispObjectAdder(result));
+}
+
 void LispPatchLoad(LispEnvironment& aEnvironment, int aStackTop)
 {
     LispPtr evaluated(ARGUMENT(1));
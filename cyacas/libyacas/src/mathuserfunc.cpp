@@ -6,15 +6,23 @@
 #include "yacas/standard.h"
 #include "yacas/substitute.h"
 
+#include <algorithm>
 #include <memory>
+#include <typeinfo>
 
 #define InternalEval aEnvironment.iEvaluator->Eval
 
+void BranchingUserFunction::BranchRuleBase::EvalBody(
+    LispEnvironment& aEnvironment, LispPtr& aResult)
+{
+    CompiledBody::Eval(aEnvironment, aResult, Body(), iCompiledBody);
+}
+
 bool BranchingUserFunction::BranchRule::Matches(LispEnvironment& aEnvironment,
                                                 LispPtr* aArguments)
 {
     LispPtr pred;
-    InternalEval(aEnvironment, pred, iPredicate);
+    CompiledBody::Eval(aEnvironment, pred, iPredicate, iCompiledPredicate);
     return IsTrue(aEnvironment, pred);
 }
 int BranchingUserFunction::BranchRule::Precedence() const
@@ -45,11 +53,86 @@ LispPtr& BranchingUserFunction::BranchPattern::Body()
 {
     return iBody;
 }
+PatternKey
+BranchingUserFunction::BranchPattern::Key(std::size_t aParameter) const
+{
+    return iPatternClass->Key(aParameter);
+}
+
+BranchingUserFunction::RuleIndex::RuleIndex(
+    const std::vector<BranchRuleBase*>& aRules, std::size_t aParameter) :
+    iParameter(aParameter)
+{
+    // Every bucket has to see the rules without a requirement, so
+    // create all of them up front.
+    for (BranchRuleBase* rule : aRules) {
+        const PatternKey key = rule->Key(iParameter);
+        if (key.iKind == PatternKey::Atom)
+            iAtoms[key.iHead];
+        else if (key.iKind == PatternKey::List && key.iHead)
+            iListHeads[key.iHead];
+    }
+
+    for (BranchRuleBase* rule : aRules) {
+        const PatternKey key = rule->Key(iParameter);
+        switch (key.iKind) {
+        case PatternKey::Any:
+            iAny.push_back(rule);
+            iNumbers.push_back(rule);
+            iLists.push_back(rule);
+            for (auto& p : iAtoms)
+                p.second.push_back(rule);
+            for (auto& p : iListHeads)
+                p.second.push_back(rule);
+            break;
+        case PatternKey::Atom:
+            iAtoms[key.iHead].push_back(rule);
+            break;
+        case PatternKey::Number:
+            iNumbers.push_back(rule);
+            break;
+        case PatternKey::List:
+            if (key.iHead) {
+                iListHeads[key.iHead].push_back(rule);
+            } else {
+                iLists.push_back(rule);
+                for (auto& p : iListHeads)
+                    p.second.push_back(rule);
+            }
+            break;
+        }
+    }
+}
+
+const std::vector<BranchingUserFunction::BranchRuleBase*>&
+BranchingUserFunction::RuleIndex::Candidates(LispPtr* aArguments) const
+{
+    const PatternKey key = PatternKey::Of(aArguments[iParameter]);
+
+    switch (key.iKind) {
+    case PatternKey::Atom: {
+        const auto p = iAtoms.find(key.iHead);
+        return p == iAtoms.end() ? iAny : p->second;
+    }
+    case PatternKey::Number:
+        return iNumbers;
+    case PatternKey::List: {
+        if (!key.iHead)
+            return iLists;
+        const auto p = iListHeads.find(key.iHead);
+        return p == iListHeads.end() ? iLists : p->second;
+    }
+    default:
+        return iAny;
+    }
+}
 
 BranchingUserFunction::BranchingUserFunction(LispPtr& aParameters) :
     iParameters(),
     iRules(),
-    iParamList(aParameters)
+    iParamList(aParameters),
+    iIndex(),
+    iIndexed(false)
 {
     for (LispIterator iter(aParameters); iter.getObj(); ++iter) {
         if (!iter.getObj()->String())
@@ -69,9 +152,16 @@ BranchingUserFunction::~BranchingUserFunction()
 void BranchingUserFunction::Evaluate(LispPtr& aResult,
                                      LispEnvironment& aEnvironment,
                                      LispPtr& aArguments) const
+{
+    Call(aResult, aEnvironment, aArguments, false);
+}
+
+void BranchingUserFunction::Call(LispPtr& aResult,
+                                 LispEnvironment& aEnvironment,
+                                 LispPtr& aArguments,
+                                 bool aListed) const
 {
     const int arity = Arity();
-    int i;
 
     if (Traced()) {
         LispPtr tr(LispSubList::New(aArguments));
@@ -79,80 +169,126 @@ void BranchingUserFunction::Evaluate(LispPtr& aResult,
         tr = nullptr;
     }
 
-    LispIterator iter(aArguments);
-    ++iter;
+    ArgumentStack::Frame arguments(aEnvironment.iArgumentStack, arity);
 
-    // unrollable arguments
-    std::unique_ptr<LispPtr[]> arguments(arity == 0 ? nullptr
-                                                    : new LispPtr[arity]);
+    EvaluateArguments(aEnvironment, aArguments, arguments.get(), aListed);
 
-    // Walk over all arguments, evaluating them as necessary
-    for (i = 0; i < arity; i++, ++iter) {
-        if (!iter.getObj())
-            throw LispErrWrongNumberOfArgs();
+    Apply(aResult, aEnvironment, aArguments, arguments);
+}
 
-        if (iParameters[i].iHold) {
-            arguments[i] = iter.getObj()->Copy();
-        } else {
-            // Check(iter.getObj(), KLispErrWrongNumberOfArgs);  // checked
-            // above
-            InternalEval(aEnvironment, arguments[i], *iter);
-        }
-    }
+void BranchingUserFunction::Apply(LispPtr& aResult,
+                                  LispEnvironment& aEnvironment,
+                                  LispPtr& aArguments,
+                                  ArgumentStack::Frame& aValues) const
+{
+    int arity = Arity();
+    int i;
 
     if (Traced()) {
         LispIterator iter(aArguments);
         for (i = 0; i < arity; i++)
-            TraceShowArg(aEnvironment, *++iter, arguments[i]);
+            TraceShowArg(aEnvironment, *++iter, aValues[i]);
+    }
+
+    // Calls being traced are always shown in full
+    MemoTable::Key key;
+    if (iMemo && !Traced()) {
+        if (const LispPtr* known =
+                iMemo->Find(aEnvironment, aValues.get(), arity, key)) {
+            aResult = MemoTable::DeepCopy(*known);
+            return;
+        }
     }
 
     // declare a new local stack.
     LispLocalFrame frame(aEnvironment, Fenced());
+    const std::size_t locals = aEnvironment.LocalsMark();
 
-    // define the local variables.
-    for (i = 0; i < arity; i++) {
-        const LispString* variable = iParameters[i].iParameter;
-        // set the variable to the new value
-        aEnvironment.NewLocal(variable, arguments[i]);
-    }
+    // The function called and the call, which change with every call
+    // in tail position looped over instead of recursing into.
+    const BranchingUserFunction* function = this;
+    LispPtr* call = &aArguments;
+    LispPtr tail;
 
-    // walk the rules database, returning the evaluated result if the
-    // predicate is true.
-    const std::size_t nrRules = iRules.size();
-    UserStackInformation& st = aEnvironment.iEvaluator->StackInformation();
-    for (std::size_t i = 0; i < nrRules; i++) {
-        BranchRuleBase* thisRule = iRules[i];
-        assert(thisRule);
+    for (;;) {
+        // the arguments are the values of the local variables.
+        for (i = 0; i < arity; i++)
+            aEnvironment.BindLocal(function->iParameters[i].iParameter,
+                                   &aValues[i]);
 
-        st.iRulePrecedence = thisRule->Precedence();
-        bool matches = thisRule->Matches(aEnvironment, arguments.get());
-        if (matches) {
-            st.iSide = 1;
-            InternalEval(aEnvironment, aResult, thisRule->Body());
+        // walk the rules database, returning the evaluated result if
+        // the predicate is true.
+        BranchRuleBase* thisRule =
+            function->MatchingRule(aEnvironment, aValues.get());
+
+        if (!thisRule)
+            break;
+
+        aEnvironment.iEvaluator->StackInformation().iSide = 1;
+
+        LispPtr& body = thisRule->Body();
+        const BranchingUserFunction* next =
+            function->TailCall(aEnvironment, body, aValues.size());
+
+        if (!next) {
+            thisRule->EvalBody(aEnvironment, aResult);
             goto FINISH;
         }
 
-        // If rules got inserted, walk back
-        while (thisRule != iRules[i] && i > 0)
-            i--;
+        // Keep the body alive, evaluating the arguments may retract
+        // the rule.
+        tail = body;
+        call = tail->SubList();
+
+        const int nextArity = next->Arity();
+        {
+            ArgumentStack::Frame values(aEnvironment.iArgumentStack,
+                                        nextArity);
+            next->EvaluateArguments(
+                aEnvironment,
+                *call,
+                values.get(),
+                typeid(*next) == typeid(ListedBranchingUserFunction));
+
+            // The frame of the call is reused for the next one
+            aEnvironment.PopLocals(locals);
+            for (i = 0; i < nextArity; i++)
+                aValues[i] = std::move(values[i]);
+            for (; i < arity; i++)
+                aValues[i] = nullptr;
+        }
+
+        function = next;
+        arity = nextArity;
+
+        if (aEnvironment.stop_evaluation) {
+            aEnvironment.stop_evaluation = false;
+            aEnvironment.iEvaluator->ShowStack(aEnvironment,
+                                               aEnvironment.CurrentOutput());
+            throw LispErrUserInterrupt();
+        }
     }
 
     // No predicate was true: return a new expression with the evaluated
     // arguments.
 
     {
-        LispPtr full(aArguments->Copy());
-        if (arity == 0) {
+        LispPtr full((*call)->Copy());
+        // Link the arguments back to front, so that each can be moved
+        // into the list after its own tail is in place.
+        for (i = arity - 1; i > 0; i--)
+            aValues[i - 1]->Nixed() = std::move(aValues[i]);
+        if (arity == 0)
             full->Nixed() = nullptr;
-        } else {
-            full->Nixed() = arguments[0];
-            for (i = 0; i < arity - 1; i++)
-                arguments[i]->Nixed() = arguments[i + 1];
-        }
+        else
+            full->Nixed() = std::move(aValues[0]);
         aResult = LispSubList::New(full);
     }
 
 FINISH:
+    if (iMemo)
+        iMemo->Insert(key, aResult);
+
     if (Traced()) {
         LispPtr tr(LispSubList::New(aArguments));
         TraceShowLeave(aEnvironment, aResult, tr);
@@ -160,6 +296,167 @@ FINISH:
     }
 }
 
+void BranchingUserFunction::EvaluateArguments(LispEnvironment& aEnvironment,
+                                              LispPtr& aArguments,
+                                              LispPtr* aValues,
+                                              bool aListed) const
+{
+    const int arity = Arity();
+
+    LispIterator iter(aArguments);
+    ++iter;
+
+    // Walk over all arguments, evaluating them as necessary
+    for (int i = 0; i < arity; i++, ++iter) {
+        if (!iter.getObj())
+            throw LispErrWrongNumberOfArgs();
+
+        // The last parameter of a listed function takes the list of
+        // the remaining arguments, unless there is just one.
+        if (aListed && i == arity - 1 && iter.getObj()->Nixed()) {
+            LispPtr head(aEnvironment.iList->Copy());
+            head->Nixed() = iter.getObj();
+            LispPtr rest(LispSubList::New(head));
+
+            if (iParameters[i].iHold)
+                aValues[i] = std::move(rest);
+            else
+                InternalEval(aEnvironment, aValues[i], rest);
+            break;
+        }
+
+        if (iParameters[i].iHold)
+            aValues[i] = iter.getObj()->Copy();
+        else
+            InternalEval(aEnvironment, aValues[i], *iter);
+    }
+}
+
+const BranchingUserFunction*
+BranchingUserFunction::TailCall(LispEnvironment& aEnvironment,
+                                LispPtr& aBody,
+                                std::size_t aSlots) const
+{
+    // The local frame is reused, so both functions have to see nothing
+    // but their own variables. Calls being traced or remembered are
+    // made as usual.
+    if (!Fenced() || Traced())
+        return nullptr;
+
+    LispPtr* subList = aBody->SubList();
+    if (!subList || !*subList || !(*subList)->String())
+        return nullptr;
+
+    // Checked on the exact type, which is cheaper than a dynamic_cast
+    // failing on every call of a core function. Macros are not
+    // called, they are expanded in the scope of the caller.
+    const EvalFuncBase* func = ResolveCall(aEnvironment, aBody, subList);
+    if (!func || (typeid(*func) != typeid(BranchingUserFunction) &&
+                  typeid(*func) != typeid(ListedBranchingUserFunction)))
+        return nullptr;
+
+    const BranchingUserFunction* target =
+        static_cast<const BranchingUserFunction*>(func);
+
+    if (!target->Fenced() || target->Traced() || target->iMemo)
+        return nullptr;
+
+    // A call with more arguments than there are slots recurses, once:
+    // its own frame is large enough for the calls it makes in turn.
+    if (static_cast<std::size_t>(target->Arity()) > aSlots)
+        return nullptr;
+
+    if (!aEnvironment.iEvaluator->TailCall(aEnvironment, aBody))
+        return nullptr;
+
+    return target;
+}
+
+std::shared_ptr<const BranchingUserFunction::RuleIndex>
+BranchingUserFunction::Index() const
+{
+    // Below this, a linear scan is as fast as a lookup.
+    static const std::size_t MIN_INDEXED_RULES = 4;
+
+    if (iIndexed)
+        return iIndex;
+
+    iIndexed = true;
+    iIndex = nullptr;
+
+    if (iRules.size() < MIN_INDEXED_RULES)
+        return iIndex;
+
+    // Index on the argument most rules put a requirement on.
+    std::size_t best = 0, bestCount = 0;
+    for (std::size_t i = 0; i < iParameters.size(); ++i) {
+        std::size_t count = 0;
+        for (const BranchRuleBase* rule : iRules)
+            if (rule->Key(i).iKind != PatternKey::Any)
+                count += 1;
+        if (count > bestCount) {
+            best = i;
+            bestCount = count;
+        }
+    }
+
+    if (bestCount > 0)
+        iIndex = std::make_shared<const RuleIndex>(iRules, best);
+
+    return iIndex;
+}
+
+BranchingUserFunction::BranchRuleBase*
+BranchingUserFunction::MatchingRule(LispEnvironment& aEnvironment,
+                                    LispPtr* aArguments) const
+{
+    // Keep the index alive, evaluating predicates may insert rules.
+    const std::shared_ptr<const RuleIndex> index = Index();
+
+    if (!index)
+        return MatchingRule(aEnvironment, aArguments, 0);
+
+    const std::size_t nrRules = iRules.size();
+    UserStackInformation& st = aEnvironment.iEvaluator->StackInformation();
+    for (BranchRuleBase* thisRule : index->Candidates(aArguments)) {
+        st.iRulePrecedence = thisRule->Precedence();
+        if (thisRule->Matches(aEnvironment, aArguments))
+            return thisRule;
+
+        // If rules got inserted, continue from where thisRule is now
+        if (iRules.size() != nrRules) {
+            const auto i = std::find(iRules.begin(), iRules.end(), thisRule);
+            return MatchingRule(
+                aEnvironment, aArguments, i - iRules.begin() + 1);
+        }
+    }
+
+    return nullptr;
+}
+
+BranchingUserFunction::BranchRuleBase*
+BranchingUserFunction::MatchingRule(LispEnvironment& aEnvironment,
+                                    LispPtr* aArguments,
+                                    std::size_t aFirst) const
+{
+    const std::size_t nrRules = iRules.size();
+    UserStackInformation& st = aEnvironment.iEvaluator->StackInformation();
+    for (std::size_t i = aFirst; i < nrRules; i++) {
+        BranchRuleBase* thisRule = iRules[i];
+        assert(thisRule);
+
+        st.iRulePrecedence = thisRule->Precedence();
+        if (thisRule->Matches(aEnvironment, aArguments))
+            return thisRule;
+
+        // If rules got inserted, walk back
+        while (thisRule != iRules[i] && i > 0)
+            i--;
+    }
+
+    return nullptr;
+}
+
 void BranchingUserFunction::HoldArgument(const LispString* aVariable)
 {
     const std::size_t nrc = iParameters.size();
@@ -169,6 +466,11 @@ void BranchingUserFunction::HoldArgument(const LispString* aVariable)
     }
 }
 
+bool BranchingUserFunction::Held(std::size_t aParameter) const
+{
+    return iParameters[aParameter].iHold;
+}
+
 int BranchingUserFunction::Arity() const
 {
     return iParameters.size();
@@ -255,6 +557,12 @@ void BranchingUserFunction::InsertRule(int aPrecedence, BranchRuleBase* newRule)
 CONTINUE:
     // Insert it
     iRules.insert(iRules.begin() + mid, newRule);
+
+    iIndexed = false;
+    iIndex = nullptr;
+
+    if (iMemo)
+        iMemo->Clear();
 }
 
 const LispPtr& BranchingUserFunction::ArgList() const
@@ -262,6 +570,17 @@ const LispPtr& BranchingUserFunction::ArgList() const
     return iParamList;
 }
 
+void BranchingUserFunction::Memoize()
+{
+    if (!iMemo)
+        iMemo.reset(new MemoTable);
+}
+
+MemoTable* BranchingUserFunction::Memo() const
+{
+    return iMemo.get();
+}
+
 ListedBranchingUserFunction::ListedBranchingUserFunction(LispPtr& aParameters) :
     BranchingUserFunction(aParameters)
 {
@@ -274,32 +593,47 @@ bool ListedBranchingUserFunction::IsArity(int aArity) const
     return Arity() <= aArity;
 }
 
+namespace {
+    // The call \a aArguments with the arguments from the last
+    // parameter on collected in a list, unless there is just one.
+    LispPtr ListedCall(LispEnvironment& aEnvironment,
+                       LispPtr& aArguments,
+                       int aArity)
+    {
+        LispPtr newArgs;
+        LispIterator iter(aArguments);
+        LispPtr* ptr = &newArgs;
+        for (int i = 0; i < aArity && iter.getObj(); ++i, ++iter) {
+            *ptr = iter.getObj()->Copy();
+            ptr = &((*ptr)->Nixed());
+        }
+
+        if (!iter.getObj()->Nixed()) {
+            (*ptr) = (iter.getObj()->Copy());
+            ++iter;
+            assert(!iter.getObj());
+        } else {
+            LispPtr head(aEnvironment.iList->Copy());
+            head->Nixed() = iter.getObj();
+            *ptr = (LispSubList::New(head));
+        }
+
+        return newArgs;
+    }
+}
+
 void ListedBranchingUserFunction::Evaluate(LispPtr& aResult,
                                            LispEnvironment& aEnvironment,
                                            LispPtr& aArguments) const
 {
-    LispPtr newArgs;
-    LispIterator iter(aArguments);
-    LispPtr* ptr = &newArgs;
-    const int arity = Arity();
-    // Make a copy of the arguments first
-    // TODO: if we were to change the internal representation to a cons cell,
-    // this copying would not be needed
-    for (int i = 0; i < arity && iter.getObj(); ++i, ++iter) {
-        *ptr = iter.getObj()->Copy();
-        ptr = &((*ptr)->Nixed());
+    // Tracing shows the call as the function sees it
+    if (Traced()) {
+        LispPtr newArgs(ListedCall(aEnvironment, aArguments, Arity()));
+        Call(aResult, aEnvironment, newArgs, false);
+        return;
     }
 
-    if (!iter.getObj()->Nixed()) {
-        (*ptr) = (iter.getObj()->Copy());
-        ++iter;
-        assert(!iter.getObj());
-    } else {
-        LispPtr head(aEnvironment.iList->Copy());
-        head->Nixed() = iter.getObj();
-        *ptr = (LispSubList::New(head));
-    }
-    BranchingUserFunction::Evaluate(aResult, aEnvironment, newArgs);
+    Call(aResult, aEnvironment, aArguments, true);
 }
 
 MacroUserFunction::MacroUserFunction(LispPtr& aParameters) :
@@ -318,6 +652,14 @@ MacroUserFunction::MacroUserFunction(LispPtr& aParameters) :
 void MacroUserFunction::Evaluate(LispPtr& aResult,
                                  LispEnvironment& aEnvironment,
                                  LispPtr& aArguments) const
+{
+    Call(aResult, aEnvironment, aArguments, false);
+}
+
+void MacroUserFunction::Call(LispPtr& aResult,
+                             LispEnvironment& aEnvironment,
+                             LispPtr& aArguments,
+                             bool aListed) const
 {
     const int arity = Arity();
     int i;
@@ -328,23 +670,9 @@ void MacroUserFunction::Evaluate(LispPtr& aResult,
         tr = (nullptr);
     }
 
-    LispIterator iter(aArguments);
-    ++iter;
+    ArgumentStack::Frame arguments(aEnvironment.iArgumentStack, arity);
 
-    // unrollable arguments
-    std::unique_ptr<LispPtr[]> arguments(arity == 0 ? nullptr
-                                                    : new LispPtr[arity]);
-
-    // Walk over all arguments, evaluating them as necessary
-    for (i = 0; i < arity; i++, ++iter) {
-        if (!iter.getObj())
-            throw LispErrWrongNumberOfArgs();
-
-        if (iParameters[i].iHold)
-            arguments[i] = iter.getObj()->Copy();
-        else
-            InternalEval(aEnvironment, arguments[i], *iter);
-    }
+    EvaluateArguments(aEnvironment, aArguments, arguments.get(), aListed);
 
     if (Traced()) {
         LispIterator iter(aArguments);
@@ -361,35 +689,37 @@ void MacroUserFunction::Evaluate(LispPtr& aResult,
         // declare a new local stack.
         LispLocalFrame frame(aEnvironment, false);
 
-        // define the local variables.
-        for (i = 0; i < arity; i++) {
-            const LispString* variable = iParameters[i].iParameter;
-            // set the variable to the new value
-            aEnvironment.NewLocal(variable, arguments[i]);
-        }
-
-        // walk the rules database, returning the evaluated result if the
-        // predicate is true.
-        const std::size_t nrRules = iRules.size();
-        UserStackInformation& st = aEnvironment.iEvaluator->StackInformation();
-        for (std::size_t i = 0; i < nrRules; i++) {
-            BranchRuleBase* thisRule = iRules[i];
-            assert(thisRule);
-
-            st.iRulePrecedence = thisRule->Precedence();
-            const bool matches =
-                thisRule->Matches(aEnvironment, arguments.get());
-            if (matches) {
-                st.iSide = 1;
-
+        // the arguments are the values of the local variables.
+        for (i = 0; i < arity; i++)
+            aEnvironment.BindLocal(iParameters[i].iParameter, &arguments[i]);
+
+        // walk the rules database, substituting the body of the first
+        // rule whose predicate is true.
+        if (BranchRuleBase* thisRule =
+                MatchingRule(aEnvironment, arguments.get())) {
+            aEnvironment.iEvaluator->StackInformation().iSide = 1;
+
+            // Evaluators other than the basic one, and tracing, get to
+            // see the parameters evaluated for each expansion
+            MemoTable* expansions = nullptr;
+            if (!Traced() &&
+                typeid(*aEnvironment.iEvaluator) == typeid(BasicEvaluator))
+                expansions = Expansions(*thisRule);
+
+            MemoTable::Key key;
+            const LispPtr* known = nullptr;
+            if (expansions)
+                known = expansions->Find(
+                    aEnvironment, arguments.get(), arity, key);
+
+            if (known) {
+                substedBody = *known;
+            } else {
                 BackQuoteBehaviour behaviour(aEnvironment);
                 InternalSubstitute(substedBody, thisRule->Body(), behaviour);
-                break;
+                if (expansions)
+                    expansions->Insert(key, substedBody);
             }
-
-            // If rules got inserted, walk back
-            while (thisRule != iRules[i] && i > 0)
-                i--;
         }
     }
 
@@ -400,14 +730,12 @@ void MacroUserFunction::Evaluate(LispPtr& aResult,
     // arguments.
     {
         LispPtr full(aArguments->Copy());
-        if (arity == 0) {
+        for (i = arity - 1; i > 0; i--)
+            arguments[i - 1]->Nixed() = std::move(arguments[i]);
+        if (arity == 0)
             full->Nixed() = nullptr;
-        } else {
-            full->Nixed() = arguments[0];
-            for (i = 0; i < arity - 1; i++) {
-                arguments[i]->Nixed() = arguments[i + 1];
-            }
-        }
+        else
+            full->Nixed() = std::move(arguments[0]);
         aResult = LispSubList::New(full);
     }
     if (Traced()) {
@@ -417,6 +745,51 @@ void MacroUserFunction::Evaluate(LispPtr& aResult,
     }
 }
 
+MemoTable* MacroUserFunction::Expansions(BranchRuleBase& aRule) const
+{
+    const auto i = iExpansions.find(&aRule);
+    if (i != iExpansions.end())
+        return i->second.get();
+
+    MemoTable* expansions =
+        OnlyParameters(aRule.Body().ptr()) ? new MemoTable : nullptr;
+    iExpansions.emplace(&aRule, std::unique_ptr<MemoTable>(expansions));
+    return expansions;
+}
+
+bool MacroUserFunction::OnlyParameters(LispObject* aElement) const
+{
+    LispPtr* sub = aElement->SubList();
+    if (!sub)
+        return true;
+
+    LispObject* head = *sub;
+    if (head && head->String()) {
+        // Quoted again, left for later
+        if (*head->String() == "`")
+            return true;
+
+        if (*head->String() == "@" && head->Nixed()) {
+            const LispString* name = head->Nixed()->String();
+            if (!name)
+                return false;
+
+            const int arity = Arity();
+            for (int i = 0; i < arity; ++i)
+                if (iParameters[i].iParameter == name)
+                    return true;
+
+            return false;
+        }
+    }
+
+    for (LispObject* p = head; p; p = p->Nixed())
+        if (!OnlyParameters(p))
+            return false;
+
+    return true;
+}
+
 ListedMacroUserFunction::ListedMacroUserFunction(LispPtr& aParameters) :
     MacroUserFunction(aParameters)
 {
@@ -431,27 +804,12 @@ void ListedMacroUserFunction::Evaluate(LispPtr& aResult,
                                        LispEnvironment& aEnvironment,
                                        LispPtr& aArguments) const
 {
-    LispPtr newArgs;
-    LispIterator iter(aArguments);
-    LispPtr* ptr = &newArgs;
-    const int arity = Arity();
-    // TODO: the code would look a lot easier if we could do with only an
-    // iterator
-    for (int i = 0; i < arity && iter.getObj(); ++i, ++iter) {
-        *ptr = (*iter)->Copy();
-        ptr = &((*ptr)->Nixed());
-    }
-
-    if (!iter.getObj()->Nixed()) {
-        *ptr = iter.getObj()->Copy();
-        (*ptr)->Nixed();
-        ++iter;
-        assert(!iter.getObj());
-    } else {
-        LispPtr head(aEnvironment.iList->Copy());
-        head->Nixed() = iter.getObj();
-        *ptr = LispSubList::New(head);
+    // Tracing shows the call as the function sees it
+    if (Traced()) {
+        LispPtr newArgs(ListedCall(aEnvironment, aArguments, Arity()));
+        Call(aResult, aEnvironment, newArgs, false);
+        return;
     }
 
-    MacroUserFunction::Evaluate(aResult, aEnvironment, newArgs);
+    Call(aResult, aEnvironment, aArguments, true);
 }
@@ -0,0 +1,62 @@
+#include "yacas/memoryaccount.h"
+
+#include "yacas/mp/nn.hpp"
+
+namespace {
+    thread_local MemoryAccount* thread_account = nullptr;
+
+    // The limbs of big integers are charged like everything else
+    struct LimbHook {
+        LimbHook() { yacas::mp::limb_hook = &MemoryAccount::Charge; }
+    } limb_hook;
+}
+
+MemoryAccount::MemoryAccount() :
+    iExceeded(false),
+    _current(0),
+    _peak(0),
+    _limit(0),
+    _armed(true)
+{
+}
+
+MemoryAccount::Scope::Scope(MemoryAccount& aAccount) :
+    _previous(thread_account)
+{
+    thread_account = &aAccount;
+}
+
+MemoryAccount::Scope::~Scope() noexcept
+{
+    thread_account = _previous;
+}
+
+void MemoryAccount::Charge(std::ptrdiff_t aBytes) noexcept
+{
+    MemoryAccount* account = thread_account;
+
+    if (!account)
+        return;
+
+    account->_current += aBytes;
+
+    if (account->_current > account->_peak)
+        account->_peak = account->_current;
+
+    if (!account->_limit)
+        return;
+
+    if (account->_current <= account->_limit) {
+        account->_armed = true;
+    } else if (aBytes > 0 && account->_armed) {
+        account->_armed = false;
+        account->iExceeded = true;
+    }
+}
+
+void MemoryAccount::SetLimit(std::size_t aBytes)
+{
+    _limit = aBytes;
+    _armed = true;
+    iExceeded = false;
+}
@@ -0,0 +1,171 @@
+#include "yacas/memotable.h"
+#include "yacas/lispatom.h"
+#include "yacas/lispenvironment.h"
+#include "yacas/standard.h"
+
+#include <cstdint>
+
+namespace {
+    bool Rememberable(LispObject* aExpression)
+    {
+        if (aExpression->Generic())
+            return false;
+
+        if (LispPtr* sub = aExpression->SubList())
+            for (LispIterator i(*sub); i.getObj(); ++i)
+                if (!Rememberable(i.getObj()))
+                    return false;
+
+        return true;
+    }
+
+    // Structural equality, telling apart numbers that are equal but
+    // written differently
+    bool Same(LispObject* a, LispObject* b)
+    {
+        if (a == b)
+            return true;
+
+        if (!a || !b)
+            return false;
+
+        std::int64_t x, y;
+        if (LispNumber::SmallInteger(a, x))
+            return LispNumber::SmallInteger(b, y) && x == y;
+
+        if (LispPtr* la = a->SubList()) {
+            LispPtr* lb = b->SubList();
+            if (!lb)
+                return false;
+
+            LispObject* p = *la;
+            LispObject* q = *lb;
+            for (; p && q; p = p->Nixed(), q = q->Nixed())
+                if (!Same(p, q))
+                    return false;
+
+            return !p && !q;
+        }
+
+        if (b->SubList())
+            return false;
+
+        // The strings of numbers are not unique, compare what they say
+        if (a->IsNumber() || b->IsNumber())
+            return a->IsNumber() && b->IsNumber() &&
+                   *a->String() == *b->String();
+
+        return a->String() == b->String();
+    }
+}
+
+MemoTable::MemoTable() :
+    _capacity(DEFAULT_CAPACITY),
+    _generation(0),
+    _hits(0),
+    _misses(0)
+{
+}
+
+const LispPtr* MemoTable::Find(LispEnvironment& aEnvironment,
+                               const LispPtr* aArguments,
+                               std::size_t aSize,
+                               Key& aKey)
+{
+    const int precision = aEnvironment.Precision();
+
+    std::size_t hash = std::hash<int>()(precision);
+    for (std::size_t i = 0; i < aSize; ++i) {
+        if (!aArguments[i] || !Rememberable(aArguments[i]))
+            return nullptr;
+        hash = hash * 31 + InternalHash(aEnvironment, aArguments[i]);
+    }
+
+    const auto range = _index.equal_range(hash);
+    for (auto i = range.first; i != range.second; ++i) {
+        const Entries::iterator e = i->second;
+
+        if (e->key.precision != precision)
+            continue;
+
+        std::size_t j = 0;
+        while (j < aSize && Same(e->key.arguments[j], aArguments[j]))
+            ++j;
+
+        if (j == aSize) {
+            _entries.splice(_entries.begin(), _entries, e);
+            _hits += 1;
+            return &e->result;
+        }
+    }
+
+    _misses += 1;
+
+    // The arguments are copied, the ones of the call may end up in
+    // its result, or be changed in place later on
+    aKey.hash = hash;
+    aKey.precision = precision;
+    aKey.generation = _generation;
+    aKey.filled = true;
+    aKey.arguments.reserve(aSize);
+    for (std::size_t i = 0; i < aSize; ++i)
+        aKey.arguments.emplace_back(DeepCopy(aArguments[i]));
+
+    return nullptr;
+}
+
+void MemoTable::Insert(Key& aKey, const LispPtr& aResult)
+{
+    if (!aKey.filled || aKey.generation != _generation || _capacity == 0)
+        return;
+
+    Evict(_capacity - 1);
+
+    _entries.push_front(Entry{std::move(aKey), LispPtr(DeepCopy(aResult))});
+    _index.emplace(_entries.front().key.hash, _entries.begin());
+}
+
+LispObject* MemoTable::DeepCopy(LispObject* aExpression)
+{
+    LispPtr* sub = aExpression->SubList();
+    if (!sub)
+        return aExpression->Copy();
+
+    LispPtr elements;
+    LispPtr* next = &elements;
+    for (LispObject* p = *sub; p; p = p->Nixed()) {
+        *next = DeepCopy(p);
+        next = &(*next)->Nixed();
+    }
+
+    return LispSubList::New(elements);
+}
+
+void MemoTable::Clear()
+{
+    _index.clear();
+    _entries.clear();
+    _generation += 1;
+}
+
+void MemoTable::SetCapacity(std::size_t aCapacity)
+{
+    _capacity = aCapacity;
+    Evict(_capacity);
+}
+
+void MemoTable::Evict(std::size_t aSize)
+{
+    while (_entries.size() > aSize) {
+        const Entries::iterator last = std::prev(_entries.end());
+
+        const auto range = _index.equal_range(last->key.hash);
+        for (auto i = range.first; i != range.second; ++i)
+            if (i->second == last) {
+                _index.erase(i);
+                break;
+            }
+
+        _entries.erase(last);
+    }
+}
@@ -1,65 +1,376 @@
 #include "yacas/mempool.h"
+#include "yacas/memoryaccount.h"
 
 #include <algorithm>
-#include <cassert>
+#include <new>
 
-MemPool::MemPool(unsigned block_size, unsigned no_blocks) :
+#ifdef _WIN32
+#    define NOMINMAX
+#    include <windows.h>
+#else
+#    include <sys/mman.h>
+#endif
+
+struct MemPool::Slab {
+    /// Pool of the thread the slab belongs to, nullptr while in a Depot
+    std::atomic<MemPool*> owner;
+    /// Blocks freed by other threads
+    std::atomic<void*> returned;
+    /// Frees by other threads in progress, the slab is not given back
+    /// while there are any
+    std::atomic<unsigned> pending;
+
+    // Only used by the owner
+
+    /// Blocks freed by the owner
+    void* free;
+    /// Blocks from here on were never handed out
+    std::uint8_t* unused;
+    std::uint8_t* end;
+    /// Blocks handed out and not back on #free
+    unsigned used;
+
+    /// Whether the slab is on MemPool::_open
+    bool open;
+
+    Slab* prev;
+    Slab* next;
+    Slab* open_prev;
+    Slab* open_next;
+
+    /// Next slab on MemPool::_returned, written by other threads
+    Slab* returned_next;
+};
+
+namespace {
+    // Blocks start on their own cache line, away from Slab::returned
+    const std::size_t HEADER_SIZE = 128;
+
+    static_assert(sizeof (MemPool::Slab) <= HEADER_SIZE, "slab header too large");
+
+    MemPool::Slab* SlabOf(void* p)
+    {
+        const std::uintptr_t a = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<MemPool::Slab*>(a & ~(MemPool::SLAB_SIZE - 1));
+    }
+
+    void* MapSlab()
+    {
+        const std::size_t size = MemPool::SLAB_SIZE;
+
+#ifdef _WIN32
+        // The allocation granularity, 64k, aligns the slab already
+        void* p = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (!p)
+            throw std::bad_alloc();
+        return p;
+#else
+        void* p = mmap(nullptr, 2 * size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+
+        std::uint8_t* b = static_cast<std::uint8_t*>(p);
+        std::uint8_t* a = reinterpret_cast<std::uint8_t*>(
+            (reinterpret_cast<std::uintptr_t>(b) + size - 1) & ~(size - 1));
+
+        if (a != b)
+            munmap(b, a - b);
+        munmap(a + size, b + size - a);
+
+        return a;
+#endif
+    }
+
+    void UnmapSlab(void* p) noexcept
+    {
+#ifdef _WIN32
+        VirtualFree(p, 0, MEM_RELEASE);
+#else
+        munmap(p, MemPool::SLAB_SIZE);
+#endif
+    }
+
+    void* Pop(MemPool::Slab* slab, std::size_t block_size)
+    {
+        if (void* p = slab->free) {
+            slab->free = *static_cast<void**>(p);
+            slab->used += 1;
+            return p;
+        }
+
+        if (slab->unused + block_size <= slab->end) {
+            void* p = slab->unused;
+            slab->unused += block_size;
+            slab->used += 1;
+            return p;
+        }
+
+        return nullptr;
+    }
+
+    bool HasRoom(const MemPool::Slab* slab, std::size_t block_size)
+    {
+        return slab->free || slab->unused + block_size <= slab->end;
+    }
+
+    // Whether no other thread is freeing a block of the slab
+    bool Idle(MemPool::Slab* slab)
+    {
+        return slab->pending.load(std::memory_order_acquire) == 0;
+    }
+
+    // Move the blocks other threads freed to the free list of the owner
+    void Drain(MemPool::Slab* slab)
+    {
+        void* p = slab->returned.exchange(nullptr, std::memory_order_acquire);
+
+        while (p) {
+            void* next = *static_cast<void**>(p);
+            *static_cast<void**>(p) = slab->free;
+            slab->free = p;
+            slab->used -= 1;
+            p = next;
+        }
+    }
+}
+
+MemPool::MemPool(unsigned block_size, Depot& depot) :
     _block_size(std::max(static_cast<std::size_t>(block_size), sizeof(void*))),
-    _no_blocks(no_blocks),
-    _no_free_blocks(no_blocks),
-    _no_initialized_blocks(0),
-    _pool(new std::uint8_t[_block_size * _no_blocks]),
-    _next_free_block(_pool),
-    _next_pool(nullptr)
+    _depot(depot),
+    _current(nullptr),
+    _slabs(nullptr),
+    _open(nullptr),
+    _returned(nullptr)
 {
 }
 
 MemPool::~MemPool() noexcept
 {
-    assert(_no_free_blocks == _no_blocks);
+    // Slabs with blocks still in use, freed later by other threads,
+    // wait in the depot for another pool to take them over.
+    while (Slab* slab = _slabs) {
+        _slabs = slab->next;
+
+        MemoryAccount::Charge(-static_cast<std::ptrdiff_t>(SLAB_SIZE));
+
+        Drain(slab);
+
+        if (slab->used == 0 && Idle(slab)) {
+            UnmapSlab(slab);
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_depot.lock);
+        slab->owner.store(nullptr, std::memory_order_relaxed);
+        slab->prev = nullptr;
+        slab->next = _depot.slabs;
+        _depot.slabs = slab;
+    }
+
+    _current = nullptr;
+    _open = nullptr;
+}
+
+MemPool::Slab* MemPool::NewSlab()
+{
+    std::uint8_t* p = static_cast<std::uint8_t*>(MapSlab());
+
+    Slab* slab = new (p) Slab;
+    slab->owner.store(nullptr, std::memory_order_relaxed);
+    slab->returned.store(nullptr, std::memory_order_relaxed);
+    slab->pending.store(0, std::memory_order_relaxed);
+    slab->free = nullptr;
+    slab->unused = p + HEADER_SIZE;
+    slab->end = p + SLAB_SIZE;
+    slab->used = 0;
 
-    delete _next_pool;
-    delete[] _pool;
+    return slab;
 }
 
-void* MemPool::alloc()
+MemPool::Slab* MemPool::Adopt()
+{
+    std::lock_guard<std::mutex> lock(_depot.lock);
+
+    Slab* slab = _depot.slabs;
+    if (slab) {
+        _depot.slabs = slab->next;
+        // From here on, threads freeing its blocks tell this pool
+        slab->owner.store(this, std::memory_order_relaxed);
+    }
+
+    return slab;
+}
+
+void MemPool::Take(Slab* slab)
 {
-    if (_no_free_blocks) {
-        if (_no_initialized_blocks <= _no_blocks - _no_free_blocks) {
-            std::uint8_t* p = _pool + _no_initialized_blocks * _block_size;
-            *reinterpret_cast<std::uint8_t**>(p) = p + _block_size;
-            _no_initialized_blocks += 1;
+    slab->owner.store(this, std::memory_order_relaxed);
+    slab->open = false;
+
+    MemoryAccount::Charge(SLAB_SIZE);
+
+    slab->prev = nullptr;
+    slab->next = _slabs;
+    if (_slabs)
+        _slabs->prev = slab;
+    _slabs = slab;
+
+    Drain(slab);
+}
+
+void MemPool::Release(Slab* slab) noexcept
+{
+    Close(slab);
+
+    if (slab->prev)
+        slab->prev->next = slab->next;
+    else
+        _slabs = slab->next;
+
+    if (slab->next)
+        slab->next->prev = slab->prev;
+
+    MemoryAccount::Charge(-static_cast<std::ptrdiff_t>(SLAB_SIZE));
+
+    UnmapSlab(slab);
+}
+
+void MemPool::Open(Slab* slab) noexcept
+{
+    if (slab->open)
+        return;
+
+    slab->open = true;
+    slab->open_prev = nullptr;
+    slab->open_next = _open;
+    if (_open)
+        _open->open_prev = slab;
+    _open = slab;
+}
+
+void MemPool::Close(Slab* slab) noexcept
+{
+    if (!slab->open)
+        return;
+
+    slab->open = false;
+
+    if (slab->open_prev)
+        slab->open_prev->open_next = slab->open_next;
+    else
+        _open = slab->open_next;
+
+    if (slab->open_next)
+        slab->open_next->open_prev = slab->open_prev;
+}
+
+// Tell the owner of a slab that its list of returned blocks is no
+// longer empty. The slab cannot go away meanwhile, this thread is
+// counted in Slab::pending.
+void MemPool::Notify(Slab* slab) noexcept
+{
+    std::lock_guard<std::mutex> lock(_depot.lock);
+
+    // A slab in the depot is drained once adopted
+    MemPool* owner = slab->owner.load(std::memory_order_relaxed);
+    if (!owner)
+        return;
+
+    Slab* head = owner->_returned.load(std::memory_order_relaxed);
+    do
+        slab->returned_next = head;
+    while (!owner->_returned.compare_exchange_weak(
+        head, slab, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// Find a slab with room among the slabs other threads returned blocks
+// to, the own slabs known to have room and the ones in the depot
+bool MemPool::Refill()
+{
+    _current = nullptr;
+
+    if (_returned.load(std::memory_order_relaxed)) {
+        Slab* slab = _returned.exchange(nullptr, std::memory_order_acquire);
+
+        while (slab) {
+            // Once drained, the slab may be put on the list again
+            Slab* next = slab->returned_next;
+
+            Drain(slab);
+
+            if (slab->used == 0 && Idle(slab) && _open)
+                Release(slab);
+            else if (HasRoom(slab, _block_size))
+                Open(slab);
+
+            slab = next;
         }
+    }
 
-        void* ret = _next_free_block;
+    if (Slab* slab = _open) {
+        Close(slab);
+        _current = slab;
+        return true;
+    }
 
-        if (--_no_free_blocks)
-            _next_free_block =
-                *reinterpret_cast<std::uint8_t**>(_next_free_block);
-        else
-            _next_free_block = nullptr;
+    while (Slab* slab = Adopt()) {
+        Take(slab);
 
-        return ret;
+        if (HasRoom(slab, _block_size)) {
+            _current = slab;
+            return true;
+        }
     }
 
-    if (!_next_pool)
-        _next_pool = new MemPool(_block_size, _no_blocks);
+    return false;
+}
 
-    return _next_pool->alloc();
+void* MemPool::alloc()
+{
+    if (_current)
+        if (void* p = Pop(_current, _block_size))
+            return p;
+
+    if (!Refill()) {
+        Take(NewSlab());
+        _current = _slabs;
+    }
+
+    return Pop(_current, _block_size);
 }
 
 void MemPool::free(void* p) noexcept
 {
-    if (p >= _pool && p < _pool + _block_size * _no_blocks) {
-        if (_next_free_block) {
-            *reinterpret_cast<std::uint8_t**>(p) = _next_free_block;
-            _next_free_block = static_cast<std::uint8_t*>(p);
-        } else {
-            *reinterpret_cast<std::uint8_t**>(p) = _pool + _no_blocks;
-            _next_free_block = static_cast<std::uint8_t*>(p);
-        }
-        _no_free_blocks += 1;
-    } else {
-        _next_pool->free(p);
+    Slab* slab = SlabOf(p);
+
+    // Only this thread makes itself the owner of a slab, and stops
+    // being it, so the relaxed load tells reliably whether it is.
+    if (slab->owner.load(std::memory_order_relaxed) == this) {
+        const bool full = !HasRoom(slab, _block_size);
+
+        *static_cast<void**>(p) = slab->free;
+        slab->free = p;
+
+        if (slab == _current)
+            --slab->used;
+        else if (--slab->used == 0 && Idle(slab))
+            Release(slab);
+        else if (full)
+            Open(slab);
+
+        return;
     }
+
+    slab->pending.fetch_add(1, std::memory_order_relaxed);
+
+    void* head = slab->returned.load(std::memory_order_relaxed);
+    do
+        *static_cast<void**>(p) = head;
+    while (!slab->returned.compare_exchange_weak(
+        head, p, std::memory_order_release, std::memory_order_relaxed));
+
+    // The owner looks at the slab again only once told
+    if (!head)
+        Notify(slab);
+
+    slab->pending.fetch_sub(1, std::memory_order_release);
 }
@@ -26,3 +26,9 @@ bool PatternClass::Matches(LispEnvironment& aEnvironment, LispPtr* aArguments)
     assert(iPatternMatcher);
     return iPatternMatcher->Matches(aEnvironment, aArguments);
 }
+
+PatternKey PatternClass::Key(std::size_t aParameter) const
+{
+    assert(iPatternMatcher);
+    return iPatternMatcher->Key(aParameter);
+}
@@ -4,76 +4,25 @@
 #include "yacas/mathuserfunc.h"
 #include "yacas/standard.h"
 
-#include <memory>
+#include <algorithm>
 
-bool MatchAtom::ArgumentMatches(LispEnvironment& aEnvironment,
-                                LispPtr& aExpression,
-                                LispPtr* arguments) const
+PatternKey PatternKey::Of(LispObject* aExpression)
 {
-    // If it is a floating point, don't even bother comparing
-    if (!!aExpression)
-        if (aExpression->Number(0))
-            if (!aExpression->Number(0)->IsInt())
-                return false;
-
-    return (iString == aExpression->String());
-}
-
-bool MatchNumber::ArgumentMatches(LispEnvironment& aEnvironment,
-                                  LispPtr& aExpression,
-                                  LispPtr* arguments) const
-{
-    if (aExpression->Number(aEnvironment.Precision()))
-        return iNumber->Equals(*aExpression->Number(aEnvironment.Precision()));
-
-    return false;
-}
-
-bool MatchVariable::ArgumentMatches(LispEnvironment& aEnvironment,
-                                    LispPtr& aExpression,
-                                    LispPtr* arguments) const
-{
-    if (!arguments[iVarIndex]) {
-        arguments[iVarIndex] = aExpression;
-        return true;
+    // Numbers carry a string too, so check for them first.
+    if (aExpression->IsNumber())
+        return PatternKey(Number);
+
+    if (const LispString* s = aExpression->String())
+        return PatternKey(Atom, s);
+
+    if (LispPtr* sublist = aExpression->SubList()) {
+        LispObject* head = *sublist;
+        if (head && !head->IsNumber())
+            return PatternKey(List, head->String());
+        return PatternKey(List);
     }
 
-    if (InternalEquals(aEnvironment, aExpression, arguments[iVarIndex]))
-        return true;
-
-    return false;
-}
-
-bool MatchSubList::ArgumentMatches(LispEnvironment& aEnvironment,
-                                   LispPtr& aExpression,
-                                   LispPtr* arguments) const
-{
-    if (!aExpression->SubList())
-        return false;
-
-    LispIterator iter(aExpression);
-    LispObject* pObj = iter.getObj();
-
-    if (!pObj)
-        throw LispErrInvalidArg();
-
-    LispPtr* pPtr = pObj->SubList();
-
-    if (!pPtr)
-        throw LispErrNotList();
-
-    iter = *pPtr;
-
-    const int iNrMatchers = iMatchers.size();
-    for (int i = 0; i < iNrMatchers; i++, ++iter) {
-        if (!iter.getObj())
-            return false;
-        if (!iMatchers[i]->ArgumentMatches(aEnvironment, *iter, arguments))
-            return false;
-    }
-    if (iter.getObj())
-        return false;
-    return true;
+    return PatternKey();
 }
 
 int YacasPatternPredicateBase::LookUp(const LispString* aVariable)
@@ -87,152 +36,269 @@ int YacasPatternPredicateBase::LookUp(const LispString* aVariable)
     return iVariables.size() - 1;
 }
 
-const YacasParamMatcherBase*
-YacasPatternPredicateBase::MakeParamMatcher(LispEnvironment& aEnvironment,
-                                            LispObject* aPattern)
+std::size_t
+YacasPatternPredicateBase::Compile(LispEnvironment& aEnvironment,
+                                   LispObject* aPattern)
 {
-    if (!aPattern)
-        return nullptr;
+    assert(aPattern);
 
-    if (aPattern->Number(aEnvironment.Precision()))
-        return new MatchNumber(aPattern->Number(aEnvironment.Precision()));
+    if (aPattern->Number(aEnvironment.Precision())) {
+        PatternInstruction instruction(PatternInstruction::Number);
+        instruction.iNumber = aPattern->Number(aEnvironment.Precision());
+        iProgram.push_back(instruction);
+        return 0;
+    }
 
     // Deal with atoms
-    if (aPattern->String())
-        return new MatchAtom(aPattern->String());
+    if (aPattern->String()) {
+        PatternInstruction instruction(PatternInstruction::Atom);
+        instruction.iString = aPattern->String();
+        iProgram.push_back(instruction);
+        return 0;
+    }
 
     // Else it must be a sublist
-    if (aPattern->SubList()) {
-        // See if it is a variable template:
-        LispPtr* sublist = aPattern->SubList();
-        assert(sublist);
-
-        int num = InternalListLength(*sublist);
-
-        // variable matcher here...
-        if (num > 1) {
-            LispObject* head = (*sublist);
-            if (head->String() == aEnvironment.HashTable().LookUp("_")) {
-                LispObject* second = head->Nixed();
-                if (second->String()) {
-                    int index = LookUp(second->String());
-
-                    // Make a predicate for the type, if needed
-                    if (num > 2) {
-                        LispPtr third;
-
-                        LispObject* predicate = second->Nixed();
-                        if (predicate->SubList()) {
-                            InternalFlatCopy(third, *predicate->SubList());
-                        } else {
-                            third = (second->Nixed()->Copy());
-                        }
-
-                        LispObject* last = third;
-                        while (!!last->Nixed())
-                            last = last->Nixed();
-
-                        last->Nixed() =
-                            LispAtom::New(aEnvironment, *second->String());
-
-                        iPredicates.push_back(LispPtr(LispSubList::New(third)));
+    LispPtr* sublist = aPattern->SubList();
+    assert(sublist);
+
+    int num = InternalListLength(*sublist);
+
+    // variable matcher here...
+    if (num > 1) {
+        LispObject* head = (*sublist);
+        if (head->String() == aEnvironment.HashTable().LookUp("_")) {
+            LispObject* second = head->Nixed();
+            if (second->String()) {
+                int index = LookUp(second->String());
+
+                // Make a predicate for the type, if needed
+                if (num > 2) {
+                    LispPtr third;
+
+                    LispObject* predicate = second->Nixed();
+                    if (predicate->SubList()) {
+                        InternalFlatCopy(third, *predicate->SubList());
+                    } else {
+                        third = (second->Nixed()->Copy());
                     }
-                    return new MatchVariable(index);
+
+                    LispObject* last = third;
+                    while (!!last->Nixed())
+                        last = last->Nixed();
+
+                    last->Nixed() =
+                        LispAtom::New(aEnvironment, *second->String());
+
+                    iPredicates.push_back(LispPtr(LispSubList::New(third)));
                 }
+
+                PatternInstruction instruction(PatternInstruction::Variable);
+                instruction.iIndex = index;
+                iProgram.push_back(instruction);
+                return 0;
             }
         }
+    }
+
+    std::size_t depth = 0;
+    iProgram.push_back(PatternInstruction(PatternInstruction::Enter));
+    for (LispIterator iter(*sublist); iter.getObj(); ++iter)
+        depth = std::max(depth, Compile(aEnvironment, iter.getObj()));
+    iProgram.push_back(PatternInstruction(PatternInstruction::Leave));
+
+    return depth + 1;
+}
 
-        std::vector<const YacasParamMatcherBase*> matchers;
-        matchers.reserve(num);
-        LispIterator iter(*sublist);
-        for (int i = 0; i < num; ++i, ++iter) {
-            matchers.push_back(MakeParamMatcher(aEnvironment, iter.getObj()));
-            assert(matchers[i]);
+bool YacasPatternPredicateBase::ArgumentMatches(LispEnvironment& aEnvironment,
+                                                std::size_t aParameter,
+                                                LispPtr& aExpression,
+                                                LispPtr* arguments)
+{
+    const PatternInstruction* pc = iProgram.data() + iParameters[aParameter];
+    const PatternInstruction* end =
+        iProgram.data() + iParameters[aParameter + 1];
+
+    LispPtr** sp = iStack.data();
+    LispPtr* cursor = &aExpression;
+
+    for (; pc != end; ++pc) {
+        switch (pc->iOpCode) {
+        case PatternInstruction::Atom: {
+            LispObject* obj = *cursor;
+            if (!obj || obj->IsNumber() || obj->String() != pc->iString)
+                return false;
+            cursor = &obj->Nixed();
+            break;
+        }
+        case PatternInstruction::Number: {
+            LispObject* obj = *cursor;
+            if (!obj)
+                return false;
+            BigNumber* number = obj->Number(aEnvironment.Precision());
+            if (!number || !pc->iNumber->Equals(*number))
+                return false;
+            cursor = &obj->Nixed();
+            break;
+        }
+        case PatternInstruction::Variable: {
+            LispObject* obj = *cursor;
+            if (!obj)
+                return false;
+            LispPtr& value = arguments[pc->iIndex];
+            if (!value)
+                value = obj;
+            else if (!InternalEquals(aEnvironment, *cursor, value))
+                return false;
+            cursor = &obj->Nixed();
+            break;
+        }
+        case PatternInstruction::Enter: {
+            LispObject* obj = *cursor;
+            if (!obj || !obj->SubList())
+                return false;
+            *sp++ = &obj->Nixed();
+            cursor = obj->SubList();
+            break;
+        }
+        case PatternInstruction::Leave:
+            if (!!*cursor)
+                return false;
+            cursor = *--sp;
+            break;
         }
-        return new MatchSubList(std::move(matchers));
     }
 
-    return nullptr;
+    return true;
 }
 
 YacasPatternPredicateBase::YacasPatternPredicateBase(
     LispEnvironment& aEnvironment, LispPtr& aPattern, LispPtr& aPostPredicate)
 {
+    std::size_t depth = 0;
     for (LispIterator iter(aPattern); iter.getObj(); ++iter) {
-        const YacasParamMatcherBase* matcher =
-            MakeParamMatcher(aEnvironment, iter.getObj());
-        assert(matcher != nullptr);
-        iParamMatchers.push_back(matcher);
+        iParameters.push_back(iProgram.size());
+        depth = std::max(depth, Compile(aEnvironment, iter.getObj()));
     }
+    iParameters.push_back(iProgram.size());
+
+    iStack.resize(depth);
 
     iPredicates.push_back(aPostPredicate);
 }
 
+namespace {
+    // Slots for the values of the pattern variables on
+    // LispEnvironment::iPatternBindings, released again when going
+    // out of scope.
+    class PatternBindings: NonCopyable {
+    public:
+        PatternBindings(LispEnvironment& aEnvironment, std::size_t aSize):
+            iStack(aEnvironment.iPatternBindings),
+            iMark(iStack.size())
+        {
+            iStack.resize(iMark + aSize);
+        }
+
+        ~PatternBindings()
+        {
+            iStack.resize(iMark);
+        }
+
+        LispPtr* get()
+        {
+            return iStack.data() + iMark;
+        }
+
+        std::size_t first() const
+        {
+            return iMark;
+        }
+
+    private:
+        std::vector<LispPtr>& iStack;
+        std::size_t iMark;
+    };
+}
+
 bool YacasPatternPredicateBase::Matches(LispEnvironment& aEnvironment,
                                         LispPtr& aArguments)
 {
-    std::unique_ptr<LispPtr[]> arguments(
-        iVariables.empty() ? nullptr : new LispPtr[iVariables.size()]);
+    PatternBindings arguments(aEnvironment, iVariables.size());
 
     LispIterator iter(aArguments);
-    const std::size_t n = iParamMatchers.size();
+    const std::size_t n = iParameters.size() - 1;
 
     for (std::size_t i = 0; i < n; ++i, ++iter) {
 
         if (!iter.getObj())
             return false;
 
-        if (!iParamMatchers[i]->ArgumentMatches(
-                aEnvironment, *iter, arguments.get()))
+        if (!ArgumentMatches(aEnvironment, i, *iter, arguments.get()))
             return false;
     }
 
     if (iter.getObj())
         return false;
 
-    {
-        // set the local variables.
-        LispLocalFrame frame(aEnvironment, false);
-
-        SetPatternVariables(aEnvironment, arguments.get());
-
-        // do the predicates
-        if (!CheckPredicates(aEnvironment))
-            return false;
-    }
-
-    // set the local variables for sure now
-    SetPatternVariables(aEnvironment, arguments.get());
-
-    return true;
+    return MatchPredicates(aEnvironment, arguments.first());
 }
 
 bool YacasPatternPredicateBase::Matches(LispEnvironment& aEnvironment,
                                         LispPtr* aArguments)
 {
-    std::unique_ptr<LispPtr[]> arguments(
-        iVariables.empty() ? nullptr : new LispPtr[iVariables.size()]);
+    PatternBindings arguments(aEnvironment, iVariables.size());
 
-    const std::size_t n = iParamMatchers.size();
+    const std::size_t n = iParameters.size() - 1;
     for (std::size_t i = 0; i < n; ++i)
-        if (!iParamMatchers[i]->ArgumentMatches(
-                aEnvironment, aArguments[i], arguments.get()))
+        if (!ArgumentMatches(
+                aEnvironment, i, aArguments[i], arguments.get()))
             return false;
 
-    {
-        // set the local variables.
-        LispLocalFrame frame(aEnvironment, false);
-        SetPatternVariables(aEnvironment, arguments.get());
+    return MatchPredicates(aEnvironment, arguments.first());
+}
 
-        // do the predicates
-        if (!CheckPredicates(aEnvironment))
-            return false;
-    }
+bool YacasPatternPredicateBase::MatchPredicates(LispEnvironment& aEnvironment,
+                                                std::size_t aBindings)
+{
+    const std::size_t mark = aEnvironment.LocalsMark();
 
-    // set the local variables for sure now
-    SetPatternVariables(aEnvironment, arguments.get());
+    SetPatternVariables(aEnvironment,
+                        aEnvironment.iPatternBindings.data() + aBindings);
 
-    return true;
+    const bool matches = CheckPredicates(aEnvironment);
+
+    // Drop what the predicates declared; they may also have assigned
+    // to the pattern variables, so the body gets the matched values
+    // afresh. Matches made by the predicates may have moved the
+    // bindings.
+    aEnvironment.PopLocals(mark);
+
+    if (matches)
+        SetPatternVariables(aEnvironment,
+                            aEnvironment.iPatternBindings.data() + aBindings);
+
+    return matches;
+}
+
+PatternKey YacasPatternPredicateBase::Key(std::size_t aParameter) const
+{
+    if (aParameter + 1 >= iParameters.size())
+        return PatternKey();
+
+    const PatternInstruction* pc = iProgram.data() + iParameters[aParameter];
+
+    switch (pc->iOpCode) {
+    case PatternInstruction::Atom:
+        return PatternKey(PatternKey::Atom, pc->iString);
+    case PatternInstruction::Number:
+        return PatternKey(PatternKey::Number);
+    case PatternInstruction::Enter:
+        if (pc[1].iOpCode == PatternInstruction::Atom)
+            return PatternKey(PatternKey::List, pc[1].iString);
+        return PatternKey(PatternKey::List);
+    default:
+        return PatternKey();
+    }
 }
 
 bool YacasPatternPredicateBase::CheckPredicates(LispEnvironment& aEnvironment)
@@ -273,8 +339,3 @@ void YacasPatternPredicateBase::SetPatternVariables(
         aEnvironment.NewLocal(iVariables[i], arguments[i]);
 }
 
-YacasPatternPredicateBase::~YacasPatternPredicateBase()
-{
-    for (const YacasParamMatcherBase* p : iParamMatchers)
-        delete p;
-}
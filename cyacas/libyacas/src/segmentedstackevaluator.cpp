@@ -0,0 +1,176 @@
+#include "yacas/lispeval.h"
+#include "yacas/errors.h"
+#include "yacas/memoryaccount.h"
+
+#include <cstdint>
+#include <exception>
+
+#ifdef YACAS_HAVE_UCONTEXT
+#include <ucontext.h>
+#endif
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define YACAS_ASAN
+#endif
+#elif defined(__SANITIZE_ADDRESS__)
+#define YACAS_ASAN
+#endif
+
+#ifdef YACAS_ASAN
+#include <sanitizer/asan_interface.h>
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+namespace {
+#ifdef YACAS_HAVE_UCONTEXT
+    // An evaluation handed over to a segment, and the way back
+    struct Call {
+        SegmentedStackEvaluator* evaluator;
+        LispEnvironment* environment;
+        LispPtr* result;
+        LispPtr* expression;
+        std::exception_ptr error;
+        ucontext_t caller;
+        ucontext_t callee;
+#ifdef YACAS_ASAN
+        // The stack of the caller, for AddressSanitizer to switch back
+        const void* bottom;
+        std::size_t size;
+#endif
+    };
+
+    // The call the segment being switched to is to make; makecontext()
+    // can only pass ints on.
+    thread_local Call* pending = nullptr;
+#endif
+
+    // Stacks grow down on all platforms supported
+    bool Below(const void* a, const void* b)
+    {
+        return reinterpret_cast<std::uintptr_t>(a) <
+               reinterpret_cast<std::uintptr_t>(b);
+    }
+}
+
+SegmentedStackEvaluator::SegmentedStackEvaluator() :
+    iDepth(0),
+    iLimit(nullptr)
+{
+}
+
+SegmentedStackEvaluator::~SegmentedStackEvaluator()
+{
+    MemoryAccount::Charge(
+        -static_cast<std::ptrdiff_t>(iSegments.size() * SEGMENT_SIZE));
+}
+
+void SegmentedStackEvaluator::Eval(LispEnvironment& aEnvironment,
+                                   LispPtr& aResult,
+                                   LispPtr& aExpression)
+{
+    assert(aExpression);
+
+    CheckInterrupt(aEnvironment);
+
+    aEnvironment.iEvalDepth++;
+
+    const char here = 0;
+    if (!iLimit || Below(&here, iLimit))
+        EvalOnSegment(aEnvironment, aResult, aExpression);
+    else
+        EvalStep(aEnvironment, aResult, aExpression);
+
+    aEnvironment.iEvalDepth--;
+}
+
+#ifdef YACAS_HAVE_UCONTEXT
+
+void SegmentedStackEvaluator::EvalOnSegment(LispEnvironment& aEnvironment,
+                                            LispPtr& aResult,
+                                            LispPtr& aExpression)
+{
+    if (iDepth == iSegments.size()) {
+        iSegments.emplace_back(new char[SEGMENT_SIZE]);
+        MemoryAccount::Charge(SEGMENT_SIZE);
+    }
+
+    char* segment = iSegments[iDepth].get();
+
+    Call call;
+    call.evaluator = this;
+    call.environment = &aEnvironment;
+    call.result = &aResult;
+    call.expression = &aExpression;
+
+    if (getcontext(&call.callee) != 0)
+        throw LispErrNotEnoughMemory();
+
+    call.callee.uc_stack.ss_sp = segment;
+    call.callee.uc_stack.ss_size = SEGMENT_SIZE;
+    call.callee.uc_link = &call.caller;
+    makecontext(&call.callee, &SegmentedStackEvaluator::Run, 0);
+
+    const char* const limit = iLimit;
+    iLimit = segment + RESERVE;
+    iDepth += 1;
+
+    pending = &call;
+#ifdef YACAS_ASAN
+    void* fake = nullptr;
+    __sanitizer_start_switch_fiber(&fake, segment, SEGMENT_SIZE);
+#endif
+    const int status = swapcontext(&call.caller, &call.callee);
+#ifdef YACAS_ASAN
+    __sanitizer_finish_switch_fiber(fake, nullptr, nullptr);
+    __asan_unpoison_memory_region(segment, SEGMENT_SIZE);
+#endif
+
+    iDepth -= 1;
+    iLimit = limit;
+
+    if (status != 0)
+        throw LispErrNotEnoughMemory();
+
+    if (call.error)
+        std::rethrow_exception(call.error);
+}
+
+void SegmentedStackEvaluator::Run()
+{
+    Call* call = pending;
+
+#ifdef YACAS_ASAN
+    __sanitizer_finish_switch_fiber(nullptr, &call->bottom, &call->size);
+#endif
+
+    // Nothing may unwind past the start of a segment
+    try {
+        call->evaluator->EvalStep(
+            *call->environment, *call->result, *call->expression);
+    } catch (...) {
+        call->error = std::current_exception();
+    }
+
+#ifdef YACAS_ASAN
+    __sanitizer_start_switch_fiber(nullptr, call->bottom, call->size);
+#endif
+}
+
+#else
+
+void SegmentedStackEvaluator::EvalOnSegment(LispEnvironment& aEnvironment,
+                                            LispPtr& aResult,
+                                            LispPtr& aExpression)
+{
+    if (aEnvironment.iEvalDepth >= aEnvironment.iMaxEvalDepth) {
+        ShowStack(aEnvironment, aEnvironment.CurrentOutput());
+        throw LispErrMaxRecurseDepthReached();
+    }
+
+    EvalStep(aEnvironment, aResult, aExpression);
+}
+
+void SegmentedStackEvaluator::Run() {}
+
+#endif
@@ -15,6 +15,7 @@
 #include "yacas/stringio.h"
 #include "yacas/tokenizer.h"
 
+#include <functional>
 #include <sstream>
 
 bool InternalIsList(const LispEnvironment& env, const LispPtr& aPtr)
@@ -148,12 +149,12 @@ void InternalReverseList(LispPtr& aResult, const LispPtr& aOriginal)
     LispPtr tail(aOriginal);
 
     while (!!iter) {
-        tail = iter->Nixed();
-        iter->Nixed() = (previous);
-        previous = iter;
-        iter = tail;
+        tail = std::move(iter->Nixed());
+        iter->Nixed() = std::move(previous);
+        previous = std::move(iter);
+        iter = std::move(tail);
     }
-    aResult = previous;
+    aResult = std::move(previous);
 }
 
 void InternalFlatCopy(LispPtr& aResult, const LispPtr& aOriginal)
@@ -192,6 +193,14 @@ bool InternalStrictTotalOrder(const LispEnvironment& env,
     if (e1.ptr() && !e2.ptr())
         return false;
 
+    std::int64_t a, b;
+    if (LispNumber::SmallInteger(e1, a) && LispNumber::SmallInteger(e2, b)) {
+        if (a != b)
+            return a < b;
+
+        return InternalStrictTotalOrder(env, e1->Nixed(), e2->Nixed());
+    }
+
     const BigNumber* n1 = e1->Number(env.Precision());
     const BigNumber* n2 = e2->Number(env.Precision());
 
@@ -243,6 +252,10 @@ bool InternalStrictTotalOrder(const LispEnvironment& env,
         LispIterator i2(*l2);
 
         while (i1.getObj() && i2.getObj()) {
+            // the rest of the lists is shared
+            if (i1.getObj() == i2.getObj())
+                return false;
+
             const LispPtr& p1 = *i1;
             const LispPtr& p2 = *i2;
 
@@ -284,6 +297,11 @@ bool InternalEquals(const LispEnvironment& aEnvironment,
     if (!aExpression1.ptr() || !aExpression2.ptr())
         return false;
 
+    std::int64_t a, b;
+    if (LispNumber::SmallInteger(aExpression1, a) &&
+        LispNumber::SmallInteger(aExpression2, b))
+        return a == b;
+
     /*TODO This code would be better, if BigNumber::Equals works*/
 
     BigNumber* n1 = aExpression1->Number(aEnvironment.Precision());
@@ -317,10 +335,21 @@ bool InternalEquals(const LispEnvironment& aEnvironment,
         if (!aExpression2->SubList()) {
             return false;
         }
+
+        // Hash-consed lists with different hashes differ
+        const std::size_t h1 = aExpression1->Hash();
+        const std::size_t h2 = aExpression2->Hash();
+        if (h1 && h2 && h1 != h2)
+            return false;
+
         LispIterator iter1(*aExpression1->SubList());
         LispIterator iter2(*aExpression2->SubList());
 
         while (iter1.getObj() && iter2.getObj()) {
+            // the rest of the lists is shared
+            if (iter1.getObj() == iter2.getObj())
+                return true;
+
             // compare two list elements
             if (!InternalEquals(aEnvironment, *iter1, *iter2)) {
                 return false;
@@ -342,6 +371,41 @@ bool InternalEquals(const LispEnvironment& aEnvironment,
     return false;
 }
 
+namespace {
+    std::size_t HashCombine(std::size_t seed, std::size_t value)
+    {
+        return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+}
+
+std::size_t InternalHash(const LispEnvironment& aEnvironment,
+                         const LispPtr& aExpression)
+{
+    if (!aExpression)
+        return 0;
+
+    if (const BigNumber* n = aExpression->Number(aEnvironment.Precision()))
+        return n->Hash();
+
+    if (const LispString* s = aExpression->String())
+        return std::hash<const LispString*>()(s);
+
+    if (LispPtr* l = aExpression->SubList()) {
+        if (const std::size_t h = aExpression->Hash())
+            return h;
+
+        std::size_t h = 0x2545f4914f6cdd1dull;
+        for (LispIterator i(*l); i.getObj(); ++i)
+            h = HashCombine(h, InternalHash(aEnvironment, *i));
+
+        // 0 stands for no hash in LispObject::Hash()
+        return h ? h : 1;
+    }
+
+    // InternalEquals() takes all generic objects for equal
+    return 0x9e3779b97f4a7c15ull;
+}
+
 void DoInternalLoad(LispEnvironment& aEnvironment, LispInput* aInput)
 {
     LispLocalInput localInput(aEnvironment, aInput);
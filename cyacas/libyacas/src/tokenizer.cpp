@@ -494,8 +494,10 @@ bool IsAlNum(std::uint32_t c)
     return IsAlpha(c) || std::isdigit(c);
 }
 
-std::string LispTokenizer::NextToken(LispInput& aInput)
+std::string_view LispTokenizer::NextToken(LispInput& aInput)
 {
+    iToken.clear();
+
 #ifdef YACAS_UINT32_T_IN_GLOBAL_NAMESPACE
     uint32_t c;
 #else
@@ -543,30 +545,34 @@ std::string LispTokenizer::NextToken(LispInput& aInput)
     }
 
     // parse brackets
-    if (c == '(' || c == ')' || c == '{' || c == '}' || c == '[' || c == ']')
-        return std::string(1, c);
+    if (c == '(' || c == ')' || c == '{' || c == '}' || c == '[' || c == ']') {
+        iToken.push_back(c);
+        return iToken;
+    }
 
     // percent
-    if (c == '%')
-        return std::string(1, c);
+    if (c == '%') {
+        iToken.push_back(c);
+        return iToken;
+    }
 
     // comma and semicolon
-    if (c == ',' || c == ';')
-        return std::string(1, c);
+    if (c == ',' || c == ';') {
+        iToken.push_back(c);
+        return iToken;
+    }
 
     // parse . or ..
     if (c == '.' && !std::isdigit(aInput.Peek())) {
-        std::string token;
-        token.push_back(c);
+        iToken.push_back(c);
         while (aInput.Peek() == '.')
-            token.push_back(aInput.Next());
-        return token;
+            iToken.push_back(aInput.Next());
+        return iToken;
     }
 
     // parse literal strings
     if (c == '\"') {
-        std::string str;
-        utf8::append(c, std::back_inserter(str));
+        utf8::append(c, std::back_inserter(iToken));
         while (aInput.Peek() != '\"') {
             if (aInput.Peek() == '\\') {
                 aInput.Next();
@@ -574,65 +580,61 @@ std::string LispTokenizer::NextToken(LispInput& aInput)
                 if (aInput.EndOfStream())
                     throw LispErrParsingInput();
             }
-            utf8::append(aInput.Next(), std::back_inserter(str));
+            utf8::append(aInput.Next(), std::back_inserter(iToken));
 
             if (aInput.EndOfStream())
                 throw LispErrParsingInput();
         }
-        utf8::append(aInput.Next(), std::back_inserter(str));
-        return str;
+        utf8::append(aInput.Next(), std::back_inserter(iToken));
+        return iToken;
     }
 
     // parse atoms
     if (IsAlpha(c)) {
-        std::string atom;
-        utf8::append(c, std::back_inserter(atom));
+        utf8::append(c, std::back_inserter(iToken));
         while (IsAlNum(aInput.Peek()))
-            utf8::append(aInput.Next(), std::back_inserter(atom));
-        return atom;
+            utf8::append(aInput.Next(), std::back_inserter(iToken));
+        return iToken;
     }
 
     // parse operators
     if (IsSymbolic(c)) {
-        std::string op;
-        op.push_back(c);
+        iToken.push_back(c);
         while (IsSymbolic(aInput.Peek()))
-            op.push_back(aInput.Next());
-        return op;
+            iToken.push_back(aInput.Next());
+        return iToken;
     }
 
     // parse subscripts
     if (c == '_') {
-        std::string token;
-        utf8::append(c, std::back_inserter(token));
+        utf8::append(c, std::back_inserter(iToken));
         while (aInput.Peek() == '_')
-            utf8::append(aInput.Next(), std::back_inserter(token));
-        return token;
+            utf8::append(aInput.Next(), std::back_inserter(iToken));
+        return iToken;
     }
 
     // parse numbers
     if (std::isdigit(c) || c == '.') {
-        std::string number;
-        number.push_back(c);
+        iToken.push_back(c);
 
         while (std::isdigit(aInput.Peek()))
-            number.push_back(aInput.Next());
+            iToken.push_back(aInput.Next());
 
         if (aInput.Peek() == '.') {
-            number.push_back(aInput.Next());
+            iToken.push_back(aInput.Next());
             while (std::isdigit(aInput.Peek()))
-                number.push_back(aInput.Next());
+                iToken.push_back(aInput.Next());
         }
 
         if (aInput.Peek() == 'e' || aInput.Peek() == 'E') {
-            number.push_back(aInput.Next());
+            iToken.push_back(aInput.Next());
             if (aInput.Peek() == '-' || aInput.Peek() == '+')
-                number.push_back(aInput.Next());
+                iToken.push_back(aInput.Next());
             while (std::isdigit(aInput.Peek()))
-                number.push_back(aInput.Next());
+                iToken.push_back(aInput.Next());
         }
 
-        return number;
+        return iToken;
     }
 
     throw InvalidToken();
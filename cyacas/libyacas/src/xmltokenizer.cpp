@@ -3,7 +3,7 @@
 
 #include <cctype>
 
-std::string XmlTokenizer::NextToken(LispInput& aInput)
+std::string_view XmlTokenizer::NextToken(LispInput& aInput)
 {
     char c;
 
@@ -16,10 +16,10 @@ std::string XmlTokenizer::NextToken(LispInput& aInput)
     if (aInput.EndOfStream())
         return "";
 
-    std::string s;
+    iToken.clear();
 
     c = aInput.Next();
-    s.push_back(c);
+    iToken.push_back(c);
 
     if (c == '<') {
         while (c != '>') {
@@ -28,14 +28,14 @@ std::string XmlTokenizer::NextToken(LispInput& aInput)
             if (aInput.EndOfStream())
                 throw LispErrCommentToEndOfFile();
 
-            s.push_back(c);
+            iToken.push_back(c);
         }
     } else {
         while (aInput.Peek() != '<' && !aInput.EndOfStream()) {
             c = aInput.Next();
-            s.push_back(c);
+            iToken.push_back(c);
         }
     }
 
-    return s;
+    return iToken;
 }
@@ -38,9 +38,27 @@ DefaultYacasEnvironment::DefaultYacasEnvironment(std::ostream& os) :
 
 CYacas::CYacas(std::ostream& os) : environment(os) {}
 
+std::size_t CYacas::MemoryUsage() const
+{
+    return environment.getEnv().iMemoryAccount.Current();
+}
+
+std::size_t CYacas::PeakMemoryUsage() const
+{
+    return environment.getEnv().iMemoryAccount.Peak();
+}
+
+void CYacas::SetMemoryLimit(std::size_t aBytes)
+{
+    environment.getEnv().iMemoryAccount.SetLimit(aBytes);
+}
+
 void CYacas::Evaluate(const std::string& aExpression)
 {
     LispEnvironment& env = environment.getEnv();
+
+    MemoryAccount::Scope account(env.iMemoryAccount);
+
     int stackTop = env.iStack.size();
 
     env.iErrorOutput.clear();
@@ -48,6 +66,19 @@ void CYacas::Evaluate(const std::string& aExpression)
 
     std::ostringstream iResultOutput;
 
+    // Nothing is being evaluated, so only what the environment holds
+    // on to keeps containers alive
+    if (env.iCycleCollector.Due())
+        env.iCycleCollector.Collect();
+
+    // Take apart some more of the expressions dropped earlier, they
+    // may hold on to strings.
+    LispReclaimer::Collect(LispReclaimer::SLICE);
+
+    // Between two evaluations nobody holds on to a string of the
+    // hash table, so this is where strings are collected.
+    env.HashTable().CollectIncrementally();
+
     LispPtr result;
 
     try {
@@ -9,6 +9,9 @@
 #include "yacas/standard.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -806,6 +809,80 @@ bool BigNumber::Equals(const BigNumber& aOther) const
     }
 }
 
+namespace {
+    std::size_t HashInteger(std::int64_t n)
+    {
+        return std::hash<std::int64_t>()(n);
+    }
+
+    std::size_t HashLargeInteger(bool negative, const mp::NN& magnitude)
+    {
+        std::size_t h = negative;
+        for (mp::NN::Limb limb: magnitude.limbs())
+            h = h * 31 + std::hash<mp::NN::Limb>()(limb);
+        return h;
+    }
+
+    // Bits of the mantissa a float is hashed on: floats equal up to the
+    // working precision nearly always agree on these
+    const int FLOAT_HASH_BITS = 24;
+}
+
+std::size_t BigNumber::Hash() const
+{
+    const unsigned long SMALL_BITS = 53;
+
+    if (IsInt()) {
+        if (_zz->no_bits() > SMALL_BITS) {
+            if (!_zz->is_negative())
+                return HashLargeInteger(false, _zz->to_NN());
+
+            mp::ZZ a(*_zz);
+            a.abs();
+            return HashLargeInteger(true, a.to_NN());
+        }
+
+        std::int64_t n = 0;
+        if (_zz->is_negative()) {
+            mp::ZZ a(*_zz);
+            a.abs();
+            for (auto i = a.to_NN().limbs().rbegin(); i != a.to_NN().limbs().rend(); ++i)
+                n = (n << 32) | *i;
+            n = -n;
+        } else {
+            for (auto i = _zz->to_NN().limbs().rbegin(); i != _zz->to_NN().limbs().rend(); ++i)
+                n = (n << 32) | *i;
+        }
+
+        return HashInteger(n);
+    }
+
+    const double d = Double();
+
+    // A float holding an integer hashes like that integer; past 53 bits
+    // the double cannot tell, so the float is cut to its integer part
+    if (std::fabs(d) < std::ldexp(1.0, SMALL_BITS) && d == std::round(d))
+        return HashInteger(static_cast<std::int64_t>(d));
+
+    if (std::fabs(d) >= std::ldexp(1.0, SMALL_BITS)) {
+        if (std::isinf(d))
+            return HashInteger(Sign());
+
+        BigNumber integer(*this);
+        integer.BecomeInt();
+        return integer.Hash();
+    }
+
+    // Any other float on its exponent and the leading bits of its
+    // mantissa
+    int exponent;
+    const double mantissa = std::frexp(d, &exponent);
+    const std::int64_t leading = static_cast<std::int64_t>(
+        std::round(std::ldexp(mantissa, FLOAT_HASH_BITS)));
+
+    return HashInteger(leading) * 31 + std::hash<int>()(exponent);
+}
+
 bool BigNumber::IsInt() const
 {
     return !!_zz;
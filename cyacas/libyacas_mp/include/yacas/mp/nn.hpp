@@ -22,7 +22,9 @@
 #include <algorithm>
 #include <cassert>
 #include <climits>
+#include <cstddef>
 #include <iostream>
+#include <memory>
 #include <random>
 #include <stdexcept>
 #include <string>
@@ -31,11 +33,43 @@
 
 namespace yacas {
     namespace mp {
+        /// Called with the number of bytes whenever limbs are allocated,
+        /// and with minus the number when they are freed, so that the
+        /// application can keep track of the memory big numbers take.
+        extern void (*limb_hook)(std::ptrdiff_t);
+
+        template <typename T>
+        struct LimbAllocator : std::allocator<T> {
+            template <typename U> struct rebind {
+                typedef LimbAllocator<U> other;
+            };
+
+            LimbAllocator() = default;
+            template <typename U> LimbAllocator(const LimbAllocator<U>&) {}
+
+            T* allocate(std::size_t n)
+            {
+                T* p = std::allocator<T>::allocate(n);
+                if (limb_hook)
+                    limb_hook(n * sizeof(T));
+                return p;
+            }
+
+            void deallocate(T* p, std::size_t n)
+            {
+                if (limb_hook)
+                    limb_hook(-static_cast<std::ptrdiff_t>(n * sizeof(T)));
+                std::allocator<T>::deallocate(p, n);
+            }
+        };
+
         class NN {
         public:
             typedef std::uint32_t Limb;
             typedef std::uint64_t Limb2;
 
+            typedef std::vector<Limb, LimbAllocator<Limb>> Limbs;
+
             static const NN ZERO;
             static const NN ONE;
             static const NN TWO;
@@ -123,7 +157,7 @@ namespace yacas {
             void set(unsigned long bit);
             void clear(unsigned long bit);
 
-            const std::vector<Limb>& limbs() const;
+            const Limbs& limbs() const;
 
         private:
             static constexpr int LIMB_BITS = sizeof(Limb) * CHAR_BIT;
@@ -133,8 +167,6 @@ namespace yacas {
 
             static constexpr Limb2 BASE = static_cast<Limb2>(LIMB_MAX) + 1;
 
-            typedef std::vector<Limb> Limbs;
-
             Limbs _limbs;
 
             template <typename Iter> NN(Iter b, Iter e)
@@ -184,7 +216,8 @@ namespace yacas {
                 _limbs.push_back(n);
         }
 
-        inline NN::NN(const std::vector<Limb>& limbs) : _limbs(limbs)
+        inline NN::NN(const std::vector<Limb>& limbs) :
+            _limbs(limbs.begin(), limbs.end())
         {
             drop_zeros();
         }
@@ -469,7 +502,7 @@ namespace yacas {
                 _limbs.pop_back();
         }
 
-        inline const std::vector<NN::Limb>& NN::limbs() const { return _limbs; }
+        inline const NN::Limbs& NN::limbs() const { return _limbs; }
 
         inline ::std::ostream& operator<<(::std::ostream& os, const NN& n)
         {
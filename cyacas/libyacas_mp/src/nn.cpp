@@ -113,6 +113,8 @@ namespace {
 namespace yacas {
     namespace mp {
 
+        void (*limb_hook)(std::ptrdiff_t) = nullptr;
+
         const NN NN::ZERO = NN(0u);
         const NN NN::ONE = NN(1u);
         const NN NN::TWO = NN(2u);